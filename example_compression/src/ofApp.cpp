@@ -79,6 +79,7 @@ void ofApp::setup()
     test(ofx::IO::Compression::ZLIB);
     test(ofx::IO::Compression::SNAPPY);
     test(ofx::IO::Compression::LZ4);
+    test(ofx::IO::Compression::LZ4_FRAME);
 
     // window bits can be range [8, 15] includsive.
     // level must be [1, 8] inclusive.
@@ -39,6 +39,7 @@ namespace IO {
 class AbstractByteSink;
 class AbstractBufferedByteSource;
 class ByteBuffer;
+class ByteBufferView;
 
 
 /// \brief Represents the abstract notion of a byte source.
@@ -85,6 +86,46 @@ public:
     /// \returns the number of bytes available to read.
     virtual std::size_t size() const = 0;
 
+    /// \brief Get a pointer to the bytes if they are stored contiguously.
+    ///
+    /// Sinks use this to copy the source with a single memcpy rather than
+    /// requesting a copy via readBytes().
+    ///
+    /// \returns a pointer to size() contiguous bytes or nullptr if the bytes
+    ///          are not stored contiguously or the source is empty.
+    virtual const uint8_t* getContiguousPtr() const
+    {
+        return nullptr;
+    }
+
+    /// \brief Get a contiguous chunk of the bytes in this source.
+    ///
+    /// Chunks are returned in order and together make up all of the bytes in
+    /// this source.  The default implementation returns a single chunk if
+    /// getContiguousPtr() is available.  Non-contiguous sources should
+    /// override this so that sinks can copy them chunk-by-chunk.
+    ///
+    /// \param index is the index of the chunk to query.
+    /// \param data is set to a pointer to the chunk's bytes.
+    /// \param size is set to the number of bytes in the chunk.
+    /// \returns true iff the chunk exists.  If false is returned for index 0,
+    ///          the bytes are only available via readBytes().
+    virtual bool getChunk(std::size_t index,
+                          const uint8_t*& data,
+                          std::size_t& size) const
+    {
+        const uint8_t* contiguous = getContiguousPtr();
+
+        if (index == 0 && contiguous != nullptr)
+        {
+            data = contiguous;
+            size = this->size();
+            return true;
+        }
+
+        return false;
+    }
+
 };
 
 
@@ -186,6 +227,17 @@ public:
     virtual std::size_t encode(const ByteBuffer& buffer,
                                ByteBuffer& encodedBuffer) = 0;
 
+    /// \brief Encode the contents of the buffer view.
+    ///
+    /// The default implementation copies the view into a ByteBuffer.
+    /// Subclasses should override this to encode without copying.
+    ///
+    /// \param buffer is the view of the bytes to be encoded.
+    /// \param encodedBuffer the target buffer.
+    /// \returns the number of encoded bytes or 0 if error.
+    virtual std::size_t encode(const ByteBufferView& buffer,
+                               ByteBuffer& encodedBuffer);
+
 };
 
 
@@ -207,7 +259,31 @@ public:
     /// \returns the number of decoded bytes or 0 if error.
     virtual std::size_t decode(const ByteBuffer& buffer,
                                ByteBuffer& decodedBuffer) = 0;
-                        
+
+    /// \brief Decode the contents of the buffer view.
+    ///
+    /// The default implementation copies the view into a ByteBuffer.
+    /// Subclasses should override this to decode without copying.
+    ///
+    /// \param buffer is the view of the bytes to be decoded.
+    /// \param decodedBuffer the target buffer.
+    /// \returns the number of decoded bytes or 0 if error.
+    virtual std::size_t decode(const ByteBufferView& buffer,
+                               ByteBuffer& decodedBuffer);
+
+    /// \brief Decode the contents of a buffer that is no longer needed.
+    ///
+    /// Decoders whose output is never larger than their input may decode in
+    /// place and move the buffer's storage into decodedBuffer.  The default
+    /// implementation calls decode(const ByteBuffer&, ByteBuffer&).
+    ///
+    /// \param buffer is the array of bytes to be decoded.  Its contents are
+    ///        unspecified afterwards.
+    /// \param decodedBuffer the target buffer.
+    /// \returns the number of decoded bytes or 0 if error.
+    virtual std::size_t decode(ByteBuffer&& buffer,
+                               ByteBuffer& decodedBuffer);
+
 };
 
 
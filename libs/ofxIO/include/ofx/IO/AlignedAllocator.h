@@ -0,0 +1,142 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief An allocator that returns aligned and tail-padded memory.
+///
+/// Every allocation begins on an Alignment byte boundary and is followed by
+/// at least Padding bytes that belong to the allocation but are not part of
+/// the requested elements.  Kernels that process data in Alignment-sized
+/// blocks may therefore use aligned loads and read past the last element up
+/// to the next boundary without leaving the allocation.
+///
+/// The padding bytes are uninitialized and must not be relied upon.
+///
+/// \tparam Type The element type.
+/// \tparam Alignment The alignment in bytes, a power of two from
+///         alignof(Type) to 128.
+/// \tparam Padding The number of readable bytes after the last element.
+template <typename Type, std::size_t Alignment, std::size_t Padding = Alignment>
+class AlignedAllocator
+{
+public:
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two.");
+    static_assert(Alignment >= alignof(Type),
+                  "Alignment must be at least the alignment of the element type.");
+    static_assert(Alignment <= 128,
+                  "Alignment must be at most 128 bytes.");
+
+    typedef Type value_type;
+    typedef Type* pointer;
+    typedef const Type* const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type is_always_equal;
+
+    template <typename OtherType>
+    struct rebind
+    {
+        typedef AlignedAllocator<OtherType, Alignment, Padding> other;
+    };
+
+    AlignedAllocator()
+    {
+    }
+
+    template <typename OtherType>
+    AlignedAllocator(const AlignedAllocator<OtherType, Alignment, Padding>&)
+    {
+    }
+
+    /// \brief Allocate aligned, padded memory for a number of elements.
+    /// \param count The number of elements.
+    /// \returns a pointer aligned to Alignment bytes.
+    /// \throws std::bad_alloc if the memory cannot be allocated.
+    Type* allocate(std::size_t count)
+    {
+        if (count > (SIZE_MAX - Padding - Alignment) / sizeof(Type))
+        {
+            throw std::bad_alloc();
+        }
+
+        // The byte before the aligned pointer records its distance from the
+        // start of the underlying allocation, which is 1 to Alignment bytes.
+        uint8_t* raw = static_cast<uint8_t*>(::operator new(count * sizeof(Type)
+                                                            + Padding
+                                                            + Alignment));
+
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+        std::size_t offset = Alignment - (address & (Alignment - 1));
+        uint8_t* aligned = raw + offset;
+        aligned[-1] = static_cast<uint8_t>(offset - 1);
+        return reinterpret_cast<Type*>(aligned);
+    }
+
+    /// \brief Release memory returned by allocate().
+    /// \param ptr The pointer returned by allocate().
+    void deallocate(Type* ptr, std::size_t)
+    {
+        if (ptr != nullptr)
+        {
+            uint8_t* aligned = reinterpret_cast<uint8_t*>(ptr);
+            ::operator delete(aligned - (static_cast<std::size_t>(aligned[-1]) + 1));
+        }
+    }
+
+};
+
+
+template <typename Type, typename OtherType, std::size_t Alignment, std::size_t Padding>
+inline bool operator == (const AlignedAllocator<Type, Alignment, Padding>&,
+                         const AlignedAllocator<OtherType, Alignment, Padding>&)
+{
+    return true;
+}
+
+
+template <typename Type, typename OtherType, std::size_t Alignment, std::size_t Padding>
+inline bool operator != (const AlignedAllocator<Type, Alignment, Padding>&,
+                         const AlignedAllocator<OtherType, Alignment, Padding>&)
+{
+    return false;
+}
+
+
+} } // namespace ofx::IO
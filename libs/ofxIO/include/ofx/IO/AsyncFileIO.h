@@ -0,0 +1,241 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A worker pool that loads and saves files in the background.
+///
+/// Each request returns a std::future that holds the result, or rethrows the
+/// exception that the request failed with.  Requests submitted together as a
+/// batch are sorted by path and offset before they are queued, so each file
+/// is read front to back rather than in submission order.
+///
+/// The number of bytes being read or written at once is bounded.  A load
+/// waits for its whole size to fit before it allocates its buffer, and a
+/// save blocks the submitting thread until its buffer fits.  A load always
+/// proceeds when no other load is running, so a request larger than the
+/// bound still completes and queued saves cannot stall the workers.
+///
+///     AsyncFileIO io;
+///     std::vector<AsyncFileIO::LoadRequest> requests;
+///     requests.push_back(AsyncFileIO::LoadRequest("data/a.bin"));
+///     requests.push_back(AsyncFileIO::LoadRequest("data/b.bin"));
+///     std::vector<std::future<ByteBuffer>> results = io.load(requests);
+///     // ...
+///     ByteBuffer a = results[0].get();
+///
+class AsyncFileIO
+{
+public:
+    /// \brief A request to load all or part of a file.
+    struct LoadRequest
+    {
+        /// \brief Create a LoadRequest.
+        /// \param path The path of the file to load.
+        /// \param offset The offset of the first byte to load.
+        /// \param size The number of bytes to load, or 0 to load to the end
+        ///        of the file.  Fewer bytes are loaded if the file is shorter.
+        LoadRequest(const std::string& path,
+                    std::size_t offset = 0,
+                    std::size_t size = 0);
+
+        /// \brief The path of the file to load.
+        std::string path;
+
+        /// \brief The offset of the first byte to load.
+        std::size_t offset;
+
+        /// \brief The number of bytes to load, or 0 for the rest of the file.
+        std::size_t size;
+    };
+
+    /// \brief A request to save a buffer as a file.
+    struct SaveRequest
+    {
+        /// \brief Create a SaveRequest.
+        /// \param path The path of the file to save.
+        /// \param buffer The bytes to save.
+        /// \param options A combination of ByteBufferUtils::SaveOptions.
+        SaveRequest(const std::string& path,
+                    ByteBuffer buffer,
+                    int options = ByteBufferUtils::SAVE_ATOMIC);
+
+        /// \brief The path of the file to save.
+        std::string path;
+
+        /// \brief The bytes to save.
+        ByteBuffer buffer;
+
+        /// \brief A combination of ByteBufferUtils::SaveOptions.
+        int options;
+    };
+
+    /// \brief Create an AsyncFileIO and start its worker threads.
+    /// \param numThreads The number of worker threads, or 0 for one per
+    ///        hardware thread.
+    /// \param maxBytesInFlight The maximum number of bytes being loaded or
+    ///        waiting to be saved at once.
+    AsyncFileIO(std::size_t numThreads = 0,
+                std::size_t maxBytesInFlight = DEFAULT_MAX_BYTES_IN_FLIGHT);
+
+    /// \brief Destroy the AsyncFileIO.
+    ///
+    /// Queued requests are completed before the worker threads are joined.
+    ~AsyncFileIO();
+
+    /// \brief Load all or part of a file.
+    /// \param request The file and range to load.
+    /// \returns a future holding the loaded bytes.
+    std::future<ByteBuffer> load(const LoadRequest& request);
+
+    /// \brief Load a batch of files.
+    /// \param requests The files and ranges to load.
+    /// \returns futures holding the loaded bytes, in the order of requests.
+    std::vector<std::future<ByteBuffer>> load(const std::vector<LoadRequest>& requests);
+
+    /// \brief Save a buffer as a file.
+    ///
+    /// Blocks while the bytes in flight would exceed the bound.
+    ///
+    /// \param request The buffer and path to save.
+    /// \returns a future that is true once the file has been saved.
+    std::future<bool> save(SaveRequest request);
+
+    /// \brief Save a batch of buffers.
+    ///
+    /// Blocks while the bytes in flight would exceed the bound.
+    ///
+    /// \param requests The buffers and paths to save.
+    /// \returns futures for each save, in the order of requests.
+    std::vector<std::future<bool>> save(std::vector<SaveRequest> requests);
+
+    /// \brief Block until all queued requests have completed.
+    void wait();
+
+    /// \returns the number of requests that are queued or running.
+    std::size_t getNumPendingRequests() const;
+
+    /// \returns the number of bytes currently being loaded or saved.
+    std::size_t getBytesInFlight() const;
+
+    /// \returns the maximum number of bytes in flight.
+    std::size_t getMaxBytesInFlight() const;
+
+    /// \returns the number of worker threads.
+    std::size_t getNumThreads() const;
+
+    enum
+    {
+        /// \brief The default maximum number of bytes in flight.
+        DEFAULT_MAX_BYTES_IN_FLIGHT = 256 * 1024 * 1024
+    };
+
+    /// \brief A queued load or save.
+    struct Task;
+
+private:
+    AsyncFileIO(const AsyncFileIO& that);
+    AsyncFileIO& operator = (const AsyncFileIO& that);
+
+    /// \brief Queue tasks, sorted by path and offset.
+    /// \param tasks The tasks to queue.
+    void _enqueue(std::vector<std::unique_ptr<Task>>& tasks);
+
+    /// \brief Wait until the bytes fit within the bound and claim them.
+    /// \param lock A lock held on _mutex.
+    /// \param bytes The number of bytes to claim.
+    /// \param isLoad True if the bytes are claimed by a load.
+    void _acquireBytes(std::unique_lock<std::mutex>& lock,
+                       std::size_t bytes,
+                       bool isLoad);
+
+    /// \brief Return bytes claimed with _acquireBytes().
+    /// \param bytes The number of bytes to release.
+    /// \param isLoad True if the bytes were claimed by a load.
+    void _releaseBytes(std::size_t bytes, bool isLoad);
+
+    /// \brief Run a load task on a worker thread.
+    /// \param task The task to run.
+    void _load(Task& task);
+
+    /// \brief Run a save task on a worker thread.
+    /// \param task The task to run.
+    void _save(Task& task);
+
+    /// \brief The worker thread loop.
+    void _run();
+
+    /// \brief The maximum number of bytes in flight.
+    const std::size_t _maxBytesInFlight;
+
+    /// \brief The number of bytes in flight.
+    std::size_t _bytesInFlight;
+
+    /// \brief The number of bytes being loaded.
+    std::size_t _loadBytesInFlight;
+
+    /// \brief The number of tasks that are queued or running.
+    std::size_t _numPendingRequests;
+
+    /// \brief True when the workers should exit once the queue is empty.
+    bool _stopping;
+
+    /// \brief The queued tasks.
+    std::deque<std::unique_ptr<Task>> _tasks;
+
+    /// \brief The worker threads.
+    std::vector<std::thread> _threads;
+
+    /// \brief Guards all of the state above.
+    mutable std::mutex _mutex;
+
+    /// \brief Signaled when a task is queued or the service stops.
+    std::condition_variable _taskAvailable;
+
+    /// \brief Signaled when bytes are released or a task completes.
+    std::condition_variable _progress;
+
+};
+
+
+} }  // namespace ofx::IO
@@ -0,0 +1,292 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include "ofx/IO/ByteBufferView.h"
+#include "ofx/IO/ByteOrder.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A utility for reading fields of arbitrary bit width.
+///
+/// Bits are buffered in a 64-bit accumulator that is refilled up to eight
+/// bytes at a time, so reading a field is a shift and a mask.  Fields are
+/// read most significant bit first.  With BIT_ORDER_MSB_FIRST the stream
+/// starts at the high bit of the first byte, as in most network and sensor
+/// formats; with BIT_ORDER_LSB_FIRST it starts at the low bit, as in DEFLATE.
+///
+/// The bytes being read must outlive the BitReader.
+class BitReader
+{
+public:
+    /// \brief Create a BitReader.
+    /// \param buffer The bytes to read.
+    /// \param order The order of bits within each byte.
+    BitReader(const ByteBufferView& buffer,
+              ByteOrder::BitOrder order = ByteOrder::BIT_ORDER_MSB_FIRST);
+
+    /// \brief Read a field.
+    ///
+    /// Signed types are sign-extended from numBits.
+    ///
+    /// \tparam Type An integral type.
+    /// \param numBits The width of the field, from 0 to 64 and no larger than
+    ///        the number of bits in Type.
+    /// \param value The value to read.
+    /// \returns the number of bits read or 0 if too few bits remain.
+    template <typename Type>
+    std::size_t readBits(std::size_t numBits, Type& value);
+
+    /// \brief Read an array of fixed-width fields.
+    ///
+    /// Nothing is read unless all of the fields are available.
+    ///
+    /// \tparam Type An integral type.
+    /// \param numBits The width of each field, from 0 to 64 and no larger
+    ///        than the number of bits in Type.
+    /// \param count The number of fields to read.
+    /// \param values The array to fill.
+    /// \returns the number of bits read or 0 if too few bits remain.
+    template <typename Type>
+    std::size_t readBits(std::size_t numBits, std::size_t count, Type* values);
+
+    /// \brief Read a single bit.
+    /// \param value The value to read.
+    /// \returns 1 or 0 if no bits remain.
+    std::size_t readBit(bool& value);
+
+    /// \brief Skip bits.
+    /// \param numBits The number of bits to skip.
+    /// \returns the number of bits skipped or 0 if too few bits remain.
+    std::size_t skipBits(std::size_t numBits);
+
+    /// \brief Skip to the start of the next byte.
+    /// \returns the number of bits skipped.
+    std::size_t alignToByte();
+
+    /// \returns the number of bits read.
+    std::size_t getBitOffset() const;
+
+    /// \returns the number of bits remaining.
+    std::size_t remainingBits() const;
+
+private:
+    BitReader(const BitReader& that);
+    BitReader& operator = (const BitReader& that);
+
+    /// \brief Fill the accumulator with at least 56 bits if available.
+    void _refill();
+
+    /// \brief Take bits from the accumulator.
+    /// \param numBits The number of bits to take, from 1 to 56, no more than
+    ///        are in the accumulator.
+    /// \returns the bits.
+    uint64_t _take(std::size_t numBits);
+
+    /// \brief Read up to 64 bits, which must be available.
+    /// \param numBits The number of bits to read, from 0 to 64.
+    /// \returns the bits.
+    uint64_t _read(std::size_t numBits);
+
+    /// \brief Convert raw bits to a value.
+    template <typename Type>
+    static Type _toValue(uint64_t bits, std::size_t numBits);
+
+    /// \brief The bytes being read.
+    const uint8_t* _data;
+
+    /// \brief The number of bytes being read.
+    std::size_t _size;
+
+    /// \brief The index of the next byte to load into the accumulator.
+    std::size_t _byteOffset;
+
+    /// \brief The bit accumulator.
+    ///
+    /// For BIT_ORDER_MSB_FIRST the next bit is the highest bit, otherwise the
+    /// lowest bit.
+    uint64_t _cache;
+
+    /// \brief The number of valid bits in the accumulator.
+    std::size_t _cacheBits;
+
+    /// \brief The order of bits within each byte.
+    ByteOrder::BitOrder _order;
+
+};
+
+
+inline void BitReader::_refill()
+{
+    if (_byteOffset + 8 <= _size)
+    {
+        // Load eight bytes and keep as many whole bytes as fit.
+        uint64_t word;
+        std::memcpy(&word, _data + _byteOffset, sizeof(word));
+        std::size_t numBytes = (63 - _cacheBits) / 8;
+
+        if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+        {
+            _cache |= ByteOrder::toBigEndian(word) >> _cacheBits;
+            // Clear the bits of any partially loaded byte.
+            _cache &= ~(~uint64_t(0) >> (_cacheBits + numBytes * 8));
+        }
+        else
+        {
+            word = ByteOrder::toLittleEndian(word);
+            _cache |= (word << _cacheBits) &
+                      ~(~uint64_t(0) << (_cacheBits + numBytes * 8));
+        }
+
+        _byteOffset += numBytes;
+        _cacheBits += numBytes * 8;
+    }
+    else
+    {
+        while (_cacheBits <= 56 && _byteOffset < _size)
+        {
+            uint64_t byte = _data[_byteOffset++];
+
+            if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+            {
+                _cache |= byte << (56 - _cacheBits);
+            }
+            else
+            {
+                _cache |= byte << _cacheBits;
+            }
+
+            _cacheBits += 8;
+        }
+    }
+}
+
+
+inline uint64_t BitReader::_take(std::size_t numBits)
+{
+    uint64_t bits = 0;
+
+    if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+    {
+        bits = _cache >> (64 - numBits);
+        _cache <<= numBits;
+    }
+    else
+    {
+        bits = _cache & ((uint64_t(1) << numBits) - 1);
+        _cache >>= numBits;
+    }
+
+    _cacheBits -= numBits;
+    return bits;
+}
+
+
+inline uint64_t BitReader::_read(std::size_t numBits)
+{
+    if (numBits == 0)
+    {
+        return 0;
+    }
+
+    if (_cacheBits < numBits)
+    {
+        _refill();
+    }
+
+    if (numBits <= 56)
+    {
+        return _take(numBits);
+    }
+
+    // Wide fields are read in two parts.
+    uint64_t first = _take(32);
+    _refill();
+    uint64_t second = _take(numBits - 32);
+
+    if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+    {
+        return (first << (numBits - 32)) | second;
+    }
+    else
+    {
+        return first | (second << 32);
+    }
+}
+
+
+template <typename Type>
+Type BitReader::_toValue(uint64_t bits, std::size_t numBits)
+{
+    if (std::is_signed<Type>::value && numBits > 0 && numBits < 64)
+    {
+        std::size_t shift = 64 - numBits;
+        return static_cast<Type>(static_cast<int64_t>(bits << shift) >> shift);
+    }
+
+    return static_cast<Type>(bits);
+}
+
+
+template <typename Type>
+std::size_t BitReader::readBits(std::size_t numBits, Type& value)
+{
+    return readBits(numBits, 1, &value);
+}
+
+
+template <typename Type>
+std::size_t BitReader::readBits(std::size_t numBits,
+                                std::size_t count,
+                                Type* values)
+{
+    static_assert(std::is_integral<Type>::value, "Type must be integral.");
+
+    std::size_t total = numBits * count;
+
+    if (numBits > sizeof(Type) * 8 || total > remainingBits())
+    {
+        return 0;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        values[i] = _toValue<Type>(_read(numBits), numBits);
+    }
+
+    return total;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,253 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <stdint.h>
+#include <type_traits>
+#include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteOrder.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A utility for appending fields of arbitrary bit width.
+///
+/// Bits are collected in a 64-bit accumulator and appended to the ByteBuffer
+/// several bytes at a time.  Fields are written most significant bit first,
+/// in the same bit order conventions as BitReader.
+///
+/// Call flush() after the last field to append any final partial byte.
+class BitWriter
+{
+public:
+    /// \brief Create a BitWriter.
+    /// \param buffer The ByteBuffer to append to.
+    /// \param order The order of bits within each byte.
+    BitWriter(ByteBuffer& buffer,
+              ByteOrder::BitOrder order = ByteOrder::BIT_ORDER_MSB_FIRST);
+
+    /// \brief Write a field.
+    ///
+    /// Bits of value above numBits are ignored, so negative values of signed
+    /// types are written in two's complement.
+    ///
+    /// \tparam Type An integral type.
+    /// \param numBits The width of the field, from 0 to 64.
+    /// \param value The value to write.
+    /// \returns the number of bits written.
+    template <typename Type>
+    std::size_t writeBits(std::size_t numBits, Type value);
+
+    /// \brief Write an array of fixed-width fields.
+    /// \tparam Type An integral type.
+    /// \param numBits The width of each field, from 0 to 64.
+    /// \param count The number of fields to write.
+    /// \param values The values to write.
+    /// \returns the number of bits written.
+    template <typename Type>
+    std::size_t writeBits(std::size_t numBits,
+                          std::size_t count,
+                          const Type* values);
+
+    /// \brief Write a single bit.
+    /// \param value The value to write.
+    /// \returns 1.
+    std::size_t writeBit(bool value);
+
+    /// \brief Pad with zero bits to the start of the next byte.
+    /// \returns the number of bits written.
+    std::size_t alignToByte();
+
+    /// \brief Append all buffered bits to the ByteBuffer.
+    ///
+    /// A final partial byte is padded with zero bits.
+    ///
+    /// \returns the number of padding bits written.
+    std::size_t flush();
+
+    /// \returns the number of bits written.
+    std::size_t getBitOffset() const;
+
+private:
+    BitWriter(const BitWriter& that);
+    BitWriter& operator = (const BitWriter& that);
+
+    /// \brief Append the whole bytes in the accumulator to the ByteBuffer.
+    void _drain();
+
+    /// \brief Add up to 32 bits to the accumulator.
+    /// \param numBits The number of bits, from 1 to 32.
+    /// \param bits The bits, with no bits set above numBits.
+    void _put(std::size_t numBits, uint64_t bits);
+
+    /// \brief Write up to 64 bits.
+    /// \param numBits The number of bits to write, from 0 to 64.
+    /// \param bits The bits to write.
+    void _write(std::size_t numBits, uint64_t bits);
+
+    /// \brief The ByteBuffer to append to.
+    ByteBuffer& _buffer;
+
+    /// \brief The bit accumulator.
+    ///
+    /// For BIT_ORDER_MSB_FIRST the first bit is the highest bit, otherwise
+    /// the lowest bit.
+    uint64_t _cache;
+
+    /// \brief The number of valid bits in the accumulator.
+    std::size_t _cacheBits;
+
+    /// \brief The number of bits appended to the ByteBuffer.
+    std::size_t _bitsWritten;
+
+    /// \brief The order of bits within each byte.
+    ByteOrder::BitOrder _order;
+
+};
+
+
+inline void BitWriter::_drain()
+{
+    std::size_t numBytes = _cacheBits / 8;
+
+    if (numBytes == 0)
+    {
+        return;
+    }
+
+    uint64_t word = (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+                  ? ByteOrder::toBigEndian(_cache)
+                  : ByteOrder::toLittleEndian(_cache);
+
+    std::memcpy(_buffer.appendUninitialized(numBytes), &word, numBytes);
+
+    std::size_t shift = numBytes * 8;
+
+    if (shift == 64)
+    {
+        _cache = 0;
+    }
+    else if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+    {
+        _cache <<= shift;
+    }
+    else
+    {
+        _cache >>= shift;
+    }
+
+    _cacheBits -= shift;
+    _bitsWritten += shift;
+}
+
+
+inline void BitWriter::_put(std::size_t numBits, uint64_t bits)
+{
+    if (_cacheBits + numBits > 64)
+    {
+        _drain();
+    }
+
+    if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+    {
+        _cache |= bits << (64 - _cacheBits - numBits);
+    }
+    else
+    {
+        _cache |= bits << _cacheBits;
+    }
+
+    _cacheBits += numBits;
+}
+
+
+inline void BitWriter::_write(std::size_t numBits, uint64_t bits)
+{
+    if (numBits == 0)
+    {
+        return;
+    }
+
+    if (numBits < 64)
+    {
+        bits &= (uint64_t(1) << numBits) - 1;
+    }
+
+    if (numBits <= 32)
+    {
+        _put(numBits, bits);
+    }
+    else if (_order == ByteOrder::BIT_ORDER_MSB_FIRST)
+    {
+        _put(numBits - 32, bits >> 32);
+        _put(32, bits & 0xFFFFFFFF);
+    }
+    else
+    {
+        _put(32, bits & 0xFFFFFFFF);
+        _put(numBits - 32, bits >> 32);
+    }
+}
+
+
+template <typename Type>
+std::size_t BitWriter::writeBits(std::size_t numBits, Type value)
+{
+    return writeBits(numBits, 1, &value);
+}
+
+
+template <typename Type>
+std::size_t BitWriter::writeBits(std::size_t numBits,
+                                 std::size_t count,
+                                 const Type* values)
+{
+    static_assert(std::is_integral<Type>::value, "Type must be integral.");
+
+    if (numBits > 64)
+    {
+        return 0;
+    }
+
+    std::size_t total = numBits * count;
+
+    // Grow the buffer once for the whole array.
+    _buffer.reserve(_buffer.size() + (_cacheBits + total + 7) / 8);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        _write(numBits, static_cast<uint64_t>(values[i]));
+    }
+
+    return total;
+}
+
+
+} } // namespace ofx::IO
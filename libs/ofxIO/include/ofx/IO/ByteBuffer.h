@@ -32,7 +32,18 @@
 #include <iostream>
 #include <algorithm>
 #include "ofx/IO/AbstractTypes.h"
+#include "ofx/IO/AlignedAllocator.h"
 #include "ofx/IO/ByteBufferUtils.h"
+#include "ofx/IO/DefaultInitAllocator.h"
+
+
+/// \brief The alignment in bytes of ByteBuffer storage.
+///
+/// This may be defined as 32 or 64 (or any other power of two up to 128) for
+/// the whole build.  Every translation unit must agree.
+#ifndef OFX_IO_BYTE_BUFFER_ALIGNMENT
+#define OFX_IO_BYTE_BUFFER_ALIGNMENT 64
+#endif
 
 
 namespace ofx {
@@ -41,10 +52,32 @@ namespace IO {
 
 /// \brief A flexible byte buffer.
 ///
-/// The ByteBuffer is a backed by a std::vector of bytes.
+/// The ByteBuffer is a backed by a std::vector of bytes.  The vector uses a
+/// DefaultInitAllocator so that resizeUninitialized() and
+/// appendUninitialized() can grow the buffer without zero-filling it.
+///
+/// Allocated storage begins on an ALIGNMENT byte boundary and is followed by
+/// at least PADDING readable bytes past capacity().  SIMD kernels may use
+/// aligned loads from getPtr() and may over-read up to the next ALIGNMENT
+/// boundary past size().  The values of bytes past size() are unspecified.
 class ByteBuffer: public AbstractByteSource, public AbstractByteSink
 {
 public:
+    enum
+    {
+        /// \brief The alignment in bytes of the storage.
+        ALIGNMENT = OFX_IO_BYTE_BUFFER_ALIGNMENT,
+        /// \brief The readable bytes following the storage capacity.
+        PADDING = OFX_IO_BYTE_BUFFER_ALIGNMENT
+    };
+
+    /// \brief The type of the backing data vector.
+    typedef std::vector<uint8_t,
+                        DefaultInitAllocator<uint8_t,
+                                             AlignedAllocator<uint8_t,
+                                                              ALIGNMENT,
+                                                              PADDING>>> Storage;
+
     /// \brief Construct an empty ByteBuffer.
     ByteBuffer();
 
@@ -63,10 +96,18 @@ public:
     explicit ByteBuffer(const uint8_t* buffer, std::size_t size);
 
     /// \brief Construct a ByteBuffer from a byte vector.
+    ///
+    /// The bytes are copied, because a std::vector<uint8_t> uses a different
+    /// allocator than Storage.  Fill a Storage and use
+    /// ByteBuffer(Storage&&) to hand bytes over without copying.
+    ///
     /// \param buffer is a vector of bytes.
     explicit ByteBuffer(const std::vector<uint8_t>& buffer);
 
     /// \brief Construct a ByteBuffer from a string.
+    ///
+    /// The bytes are copied.
+    ///
     /// \param buffer will be interpreted as raw bytes.
     explicit ByteBuffer(const std::string& buffer);
 
@@ -74,6 +115,31 @@ public:
     /// \param buffer is a source of bytes.
     explicit ByteBuffer(const AbstractByteSource& buffer);
 
+    /// \brief Construct a ByteBuffer that takes ownership of a storage vector.
+    ///
+    /// The bytes are not copied.
+    ///
+    /// \param buffer is the storage to take.  It is left empty.
+    explicit ByteBuffer(Storage&& buffer);
+
+    /// \brief Copy a ByteBuffer.
+    /// \param that is the ByteBuffer to copy.
+    ByteBuffer(const ByteBuffer& that);
+
+    /// \brief Move a ByteBuffer without copying its bytes.
+    /// \param that is the ByteBuffer to move.  It is left empty.
+    ByteBuffer(ByteBuffer&& that) noexcept;
+
+    /// \brief Copy a ByteBuffer.
+    /// \param that is the ByteBuffer to copy.
+    /// \returns this ByteBuffer.
+    ByteBuffer& operator = (const ByteBuffer& that);
+
+    /// \brief Move a ByteBuffer without copying its bytes.
+    /// \param that is the ByteBuffer to move.  It is left empty.
+    /// \returns this ByteBuffer.
+    ByteBuffer& operator = (ByteBuffer&& that) noexcept;
+
     /// \brief Destroy the ByteBuffer.
     virtual ~ByteBuffer();
 
@@ -82,6 +148,7 @@ public:
     virtual std::size_t readBytes(std::string& buffer) const override;
     virtual std::size_t readBytes(AbstractByteSink& buffer) const override;
     virtual std::vector<uint8_t> readBytes() const override;
+    virtual const uint8_t* getContiguousPtr() const override;
 
     virtual std::size_t writeByte(uint8_t data) override;
     virtual std::size_t writeBytes(const uint8_t* buffer, std::size_t size) override;
@@ -112,6 +179,27 @@ public:
     /// \returns the new size of the ByteBuffer.
     std::size_t resize(std::size_t size, uint8_t fillByte = 0);
 
+    /// \brief Resizes the ByteBuffer without initializing new bytes.
+    ///
+    /// This is intended for producers that immediately overwrite the new
+    /// bytes (e.g. codecs writing into an output buffer), and avoids
+    /// zero-filling memory that is about to be written.
+    ///
+    /// \param size is the new size.  If size is less than size(), the
+    /// content is reduced to the first size elements.  If size is greater
+    /// than size(), the values of the new bytes are unspecified.
+    /// \returns a pointer to the first byte or nullptr if size is 0.
+    uint8_t* resizeUninitialized(std::size_t size);
+
+    /// \brief Appends uninitialized bytes to the ByteBuffer.
+    ///
+    /// The returned pointer is valid until the ByteBuffer is next resized.
+    /// Use resize() to trim any bytes that were not written.
+    ///
+    /// \param size is the number of bytes to append.
+    /// \returns a pointer to the first appended byte.
+    uint8_t* appendUninitialized(std::size_t size);
+
     /// \brief Ensures that the backing vector has allocated bytes.
     ///
     /// This simply pre-allocates needed bytes, which can speed up the copy
@@ -122,6 +210,17 @@ public:
     /// \returns the new capacity of the ByteBuffer.
     std::size_t reserve(std::size_t capacity);
 
+    /// \brief Move the backing storage out of the ByteBuffer.
+    ///
+    /// The bytes are not copied and the ByteBuffer is left empty.
+    ///
+    /// \returns the backing storage.
+    Storage release();
+
+    /// \brief Exchange the contents of two ByteBuffers without copying.
+    /// \param that is the ByteBuffer to swap with.
+    void swap(ByteBuffer& that) noexcept;
+
     /// \param n is the element index in the ByteBuffer.
     ///
     /// The value of n should not exceed size() - 1.
@@ -139,8 +238,12 @@ public:
 	uint8_t operator [] (std::size_t n) const;
 
     /// \brief Get a const reference to the backing data vector.
+    ///
+    /// Storage is not a std::vector<uint8_t>.  Use readBytes() for a
+    /// std::vector<uint8_t> copy.
+    ///
     /// \returns a const reference to the backing data vector.
-    const std::vector<uint8_t>& getData() const;
+    const Storage& getData() const;
 
     /// \brief Get a const pointer to the backing unsigned char data vector.
     /// \returns a const pointer to the backing data vector.
@@ -182,12 +285,24 @@ public:
 
 
 private:
+    /// \brief Append bytes, handling bytes that alias this buffer.
+    /// \param buffer is the array of bytes to append.
+    /// \param size is the number of bytes in the buffer.
+    /// \returns the number of bytes appended.
+    std::size_t _append(const uint8_t* buffer, std::size_t size);
+
     /// \brief The backing byte buffer.
-    std::vector<uint8_t> _buffer;
+    Storage _buffer;
 
 };
 
 
+inline void swap(ByteBuffer& lhs, ByteBuffer& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+
 inline std::ostream& operator << (std::ostream& ostr,
                                   const ByteBuffer& byteBuffer)
 {
@@ -0,0 +1,166 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <memory>
+#include "ofx/IO/ByteBuffer.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A thread-safe pool of reusable ByteBuffers.
+///
+/// Acquired buffers are empty but keep the capacity they had when they were
+/// released, so hot encode / compress loops can reuse their output buffers
+/// rather than allocating new ones for every packet.
+///
+/// Pooled buffers are kept in power-of-two size classes.  Each thread can
+/// also keep a small cache of buffers per size class, which is used before
+/// the shared, mutex-protected free lists.
+///
+///     ByteBufferPool pool;
+///     std::unique_ptr<ByteBuffer> encoded = pool.acquire(packet.size() + 2);
+///     encoding.encode(packet, *encoded);
+///     // ...
+///     pool.release(std::move(encoded));
+///
+class ByteBufferPool
+{
+public:
+    /// \brief Usage statistics for sizing a pool.
+    struct Statistics
+    {
+        /// \brief The number of calls to acquire().
+        std::size_t acquireCount;
+
+        /// \brief The number of calls to release().
+        std::size_t releaseCount;
+
+        /// \brief The number of acquired buffers that were reused.
+        std::size_t hitCount;
+
+        /// \brief The number of acquired buffers that were allocated.
+        std::size_t missCount;
+
+        /// \brief The number of released buffers that were freed because
+        ///        they were out of range or the pool was full.
+        std::size_t discardCount;
+
+        /// \brief The number of buffers currently acquired.
+        std::size_t outstandingCount;
+
+        /// \brief The maximum number of buffers acquired at once.
+        std::size_t outstandingHighWaterMark;
+
+        /// \brief The capacity of all buffers currently held by the pool,
+        ///        including per-thread caches.
+        std::size_t pooledBytes;
+
+        /// \brief The maximum value of pooledBytes.
+        std::size_t pooledBytesHighWaterMark;
+
+        /// \brief The largest capacity requested from acquire().
+        std::size_t largestRequest;
+    };
+
+    /// \brief Create a ByteBufferPool.
+    /// \param maxPooledBytes The maximum total capacity of the buffers held
+    ///        by the pool.  Released buffers beyond this are freed.
+    /// \param threadCacheSize The maximum number of buffers cached per
+    ///        thread for each size class.  0 disables per-thread caches.
+    ByteBufferPool(std::size_t maxPooledBytes = DEFAULT_MAX_POOLED_BYTES,
+                   std::size_t threadCacheSize = DEFAULT_THREAD_CACHE_SIZE);
+
+    /// \brief Destroy the ByteBufferPool.
+    ///
+    /// Pooled buffers, including those in every thread's cache, are freed
+    /// with the pool.  Buffers that are still acquired remain valid and are
+    /// simply freed when released or destroyed.
+    virtual ~ByteBufferPool();
+
+    /// \brief Acquire an empty buffer.
+    /// \param capacity The minimum capacity of the acquired buffer.
+    /// \returns an empty buffer with at least the requested capacity.
+    std::unique_ptr<ByteBuffer> acquire(std::size_t capacity = 0);
+
+    /// \brief Return a buffer to the pool.
+    ///
+    /// The buffer is cleared, but its capacity is retained.  Buffers do not
+    /// have to be released to the pool they were acquired from.
+    ///
+    /// \param buffer The buffer to release.
+    void release(std::unique_ptr<ByteBuffer> buffer);
+
+    /// \brief Free all buffers held in the shared free lists and in the
+    ///        calling thread's cache.
+    ///
+    /// Buffers cached by other threads are returned to the shared free lists
+    /// when those threads exit.
+    void clear();
+
+    /// \returns a snapshot of the pool's statistics.
+    Statistics getStatistics() const;
+
+    /// \returns the maximum total capacity of the buffers held by the pool.
+    std::size_t getMaxPooledBytes() const;
+
+    /// \returns the maximum number of buffers cached per thread per size
+    ///          class.
+    std::size_t getThreadCacheSize() const;
+
+    enum
+    {
+        /// \brief The capacity of the smallest size class.
+        MIN_BUFFER_SIZE = 64,
+
+        /// \brief The number of power-of-two size classes.
+        NUM_SIZE_CLASSES = 24,
+
+        /// \brief The default maximum total capacity of pooled buffers.
+        DEFAULT_MAX_POOLED_BYTES = 64 * 1024 * 1024,
+
+        /// \brief The default number of cached buffers per thread per class.
+        DEFAULT_THREAD_CACHE_SIZE = 4
+    };
+
+    /// \brief The shared state of a pool.
+    struct State;
+
+private:
+    ByteBufferPool(const ByteBufferPool& that);
+    ByteBufferPool& operator = (const ByteBufferPool& that);
+
+    /// \brief The shared state, also referenced by per-thread caches.
+    std::shared_ptr<State> _state;
+
+};
+
+
+} }  // namespace ofx::IO
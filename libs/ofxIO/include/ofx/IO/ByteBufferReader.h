@@ -26,8 +26,12 @@
 #pragma once
 
 
+#include <limits>
 #include <type_traits>
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferView.h"
+#include "ofx/IO/ByteOrder.h"
+#include "ofx/IO/VarintEncoding.h"
 
 
 namespace ofx {
@@ -43,6 +47,14 @@ public:
     /// \param The byte offset.
     ByteBufferReader(const ByteBuffer& buffer, std::size_t offset = 0);
 
+    /// \brief Create a ByteBufferReader from a byte buffer view.
+    ///
+    /// The viewed bytes must outlive the ByteBufferReader.
+    ///
+    /// \param buffer The ByteBufferView to read from.
+    /// \param The byte offset.
+    ByteBufferReader(const ByteBufferView& buffer, std::size_t offset = 0);
+
     /// \brief Read a value from the ByteBuffer.
     /// \tparam Type the type to read from the ByteBuffer.
     /// \param value A reference to the value to read.
@@ -58,6 +70,107 @@ public:
     template <typename Type>
     std::size_t read(Type* destination, std::size_t size) const;
 
+    /// \brief Read a value from the ByteBuffer without advancing the offset.
+    /// \tparam Type the type to read from the ByteBuffer.
+    /// \param value A reference to the value to read.
+    /// \returns std::size_t the number of bytes read.
+    template <typename Type>
+    std::size_t peek(Type& value) const;
+
+    /// \brief Read an array of values without advancing the offset.
+    /// \tparam Type the type to read from the ByteBuffer.
+    /// \param destination The array to fill.
+    /// \param size The number of values to read into the array.
+    /// \returns std::size_t the number of bytes read.
+    template <typename Type>
+    std::size_t peek(Type* destination, std::size_t size) const;
+
+    /// \brief Read bytes as a view into the underlying buffer.
+    ///
+    /// No bytes are copied.  The view is only valid as long as the bytes
+    /// being read are not modified or destroyed.
+    ///
+    /// \param size The number of bytes to read.
+    /// \returns a view of the next size bytes, or an empty view (with the
+    ///     offset unchanged) if fewer than size bytes remain.
+    ByteBufferView readView(std::size_t size) const;
+
+    /// \brief Get a view of the next bytes without advancing the offset.
+    /// \param size The number of bytes to view.
+    /// \returns a view of the next size bytes, or an empty view if fewer
+    ///     than size bytes remain.
+    ByteBufferView peekView(std::size_t size) const;
+
+    /// \brief Read a big-endian value from the ByteBuffer.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    /// \param value A reference to the value to read in host byte order.
+    /// \returns std::size_t the number of bytes read.
+    template <typename Type>
+    std::size_t readBE(Type& value) const;
+
+    /// \brief Read a little-endian value from the ByteBuffer.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    /// \param value A reference to the value to read in host byte order.
+    /// \returns std::size_t the number of bytes read.
+    template <typename Type>
+    std::size_t readLE(Type& value) const;
+
+    /// \brief Read an array of big-endian values from the ByteBuffer.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    /// \param destination The array to fill with values in host byte order.
+    /// \param size The number of values to read into the array.
+    /// \returns std::size_t the number of bytes read.
+    template <typename Type>
+    std::size_t readBE(Type* destination, std::size_t size) const;
+
+    /// \brief Read an array of little-endian values from the ByteBuffer.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    /// \param destination The array to fill with values in host byte order.
+    /// \param size The number of values to read into the array.
+    /// \returns std::size_t the number of bytes read.
+    template <typename Type>
+    std::size_t readLE(Type* destination, std::size_t size) const;
+
+    /// \brief Read a varint-encoded unsigned integer from the ByteBuffer.
+    /// \tparam Type An unsigned integral type.
+    /// \param value A reference to the value to read.
+    /// \returns std::size_t the number of bytes read or 0 if the value is
+    ///     truncated, malformed or does not fit in Type.
+    template <typename Type>
+    std::size_t readVarint(Type& value) const;
+
+    /// \brief Read an array of varint-encoded unsigned integers.
+    ///
+    /// If any value cannot be read, the offset is left unchanged and the
+    /// contents of the destination are unspecified.
+    ///
+    /// \tparam Type An unsigned integral type.
+    /// \param destination The array to fill.
+    /// \param size The number of values to read into the array.
+    /// \returns std::size_t the number of bytes read or 0 on error.
+    template <typename Type>
+    std::size_t readVarint(Type* destination, std::size_t size) const;
+
+    /// \brief Read a zigzag varint-encoded signed integer from the ByteBuffer.
+    /// \tparam Type A signed integral type.
+    /// \param value A reference to the value to read.
+    /// \returns std::size_t the number of bytes read or 0 if the value is
+    ///     truncated, malformed or does not fit in Type.
+    template <typename Type>
+    std::size_t readZigZag(Type& value) const;
+
+    /// \brief Read an array of zigzag varint-encoded signed integers.
+    ///
+    /// If any value cannot be read, the offset is left unchanged and the
+    /// contents of the destination are unspecified.
+    ///
+    /// \tparam Type A signed integral type.
+    /// \param destination The array to fill.
+    /// \param size The number of values to read into the array.
+    /// \returns std::size_t the number of bytes read or 0 on error.
+    template <typename Type>
+    std::size_t readZigZag(Type* destination, std::size_t size) const;
+
     /// \brief Set the offset in the ByteBuffer.
     /// \param offset The byte offset.
     void setOffset(std::size_t offset);
@@ -88,8 +201,39 @@ private:
     /// \returns the number of bytes read.
     std::size_t _read(void* destination, std::size_t size) const;
 
-    /// \brief A reference to the ByteBuffer being read.
-    const ByteBuffer& _buffer;
+    /// \brief An Internal function for reading bytes without advancing.
+    /// \param destination The destination to be filled.
+    /// \param size the number of bytes to read.
+    /// \returns the number of bytes read.
+    std::size_t _peek(void* destination, std::size_t size) const;
+
+    /// \brief An Internal function for reading values in a given byte order.
+    /// \param destination The destination to be filled.
+    /// \param count the number of values to read.
+    /// \param width the number of bytes in each value.
+    /// \param flip true if the bytes of each value should be reversed.
+    /// \returns the number of bytes read.
+    std::size_t _readOrdered(void* destination,
+                             std::size_t count,
+                             std::size_t width,
+                             bool flip) const;
+
+    /// \brief An Internal function for reading varints.
+    /// \param destination The values to be filled.
+    /// \param size the number of values to read.
+    /// \returns the number of bytes read or 0 on error.
+    template <typename Type>
+    std::size_t _readVarints(Type* destination, std::size_t size) const;
+
+    /// \returns a view of the bytes being read.
+    ByteBufferView _view() const;
+
+    /// \brief A pointer to the ByteBuffer being read or nullptr if reading a
+    ///        ByteBufferView.
+    const ByteBuffer* _buffer;
+
+    /// \brief The ByteBufferView being read if _buffer is nullptr.
+    ByteBufferView _bufferView;
 
     /// \brief The current offset.
     mutable std::size_t _offset;
@@ -109,8 +253,142 @@ template <typename Type>
 std::size_t ByteBufferReader::read(Type* destination, std::size_t size) const
 {   
     static_assert(std::is_pod<Type>::value, "Type must be POD.");
+    if (size > std::numeric_limits<std::size_t>::max() / sizeof(Type))
+    {
+        return 0;
+    }
+
     return _read(destination, sizeof(Type) * size);
 }
 
 
+template <typename Type>
+std::size_t ByteBufferReader::peek(Type& value) const
+{
+    static_assert(std::is_pod<Type>::value, "Type must be POD.");
+    return _peek(&value, sizeof(Type));
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::peek(Type* destination, std::size_t size) const
+{
+    static_assert(std::is_pod<Type>::value, "Type must be POD.");
+    if (size > std::numeric_limits<std::size_t>::max() / sizeof(Type))
+    {
+        return 0;
+    }
+
+    return _peek(destination, sizeof(Type) * size);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readBE(Type& value) const
+{
+    return readBE(&value, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readLE(Type& value) const
+{
+    return readLE(&value, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readBE(Type* destination, std::size_t size) const
+{
+    static_assert(std::is_arithmetic<Type>::value || std::is_enum<Type>::value,
+                  "Type must be an arithmetic or enum type.");
+    static_assert(sizeof(Type) == 1 || sizeof(Type) == 2 ||
+                  sizeof(Type) == 4 || sizeof(Type) == 8,
+                  "Type must be 1, 2, 4 or 8 bytes.");
+    return _readOrdered(destination,
+                        size,
+                        sizeof(Type),
+                        ByteOrder::isLittleEndian());
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readLE(Type* destination, std::size_t size) const
+{
+    static_assert(std::is_arithmetic<Type>::value || std::is_enum<Type>::value,
+                  "Type must be an arithmetic or enum type.");
+    static_assert(sizeof(Type) == 1 || sizeof(Type) == 2 ||
+                  sizeof(Type) == 4 || sizeof(Type) == 8,
+                  "Type must be 1, 2, 4 or 8 bytes.");
+    return _readOrdered(destination,
+                        size,
+                        sizeof(Type),
+                        ByteOrder::isBigEndian());
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readVarint(Type& value) const
+{
+    return readVarint(&value, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readVarint(Type* destination, std::size_t size) const
+{
+    static_assert(std::is_integral<Type>::value && std::is_unsigned<Type>::value,
+                  "Type must be an unsigned integral type.");
+    return _readVarints(destination, size);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readZigZag(Type& value) const
+{
+    return readZigZag(&value, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::readZigZag(Type* destination, std::size_t size) const
+{
+    static_assert(std::is_integral<Type>::value && std::is_signed<Type>::value,
+                  "Type must be a signed integral type.");
+    return _readVarints(destination, size);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferReader::_readVarints(Type* destination, std::size_t size) const
+{
+    ByteBufferView view = _view();
+    const uint8_t* data = view.getPtr();
+    std::size_t end = view.size();
+    std::size_t offset = _offset;
+
+    if (offset > end)
+    {
+        return 0;
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        uint64_t encoded = 0;
+        std::size_t n = VarintEncoding::decode(data + offset, end - offset, encoded);
+
+        if (n == 0 || !VarintEncoding::toInteger(encoded, destination[i]))
+        {
+            return 0;
+        }
+
+        offset += n;
+    }
+
+    std::size_t count = offset - _offset;
+    _offset = offset;
+    return count;
+}
+
+
 } } // namespace ofx::IO
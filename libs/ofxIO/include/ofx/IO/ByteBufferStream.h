@@ -28,9 +28,11 @@
 
 #include <ostream>
 #include <cctype>
-#include "Poco/UnbufferedStreamBuf.h"
+#include <streambuf>
+#include "Poco/StreamUtil.h"
 #include "ofx/IO/ByteBuffer.h"
 #include "ofx/IO/ByteBufferReader.h"
+#include "ofx/IO/ByteBufferView.h"
 #include "ofx/IO/ByteBufferWriter.h"
 
 
@@ -38,18 +40,45 @@ namespace ofx {
 namespace IO {
 
 
-class ByteBufferInputStreamBuf: public Poco::UnbufferedStreamBuf
+/// \brief A stream buffer that reads a ByteBuffer or ByteBufferView.
+///
+/// All of the bytes are exposed as the get area, so stream reads copy
+/// directly from the buffer and only call into the stream buffer at the end
+/// of the data.  The stream is seekable.
+///
+/// The get area points into the bytes being read, so a ByteBuffer must not
+/// be modified, including by appending to it, while it is being read.
+class ByteBufferInputStreamBuf: public std::streambuf
 {
 public:
     ByteBufferInputStreamBuf(const ByteBuffer& buffer, std::size_t offset = 0);
-    
+
+    ByteBufferInputStreamBuf(const ByteBufferView& buffer, std::size_t offset = 0);
+
     virtual ~ByteBufferInputStreamBuf();
 
 protected:
-    int readFromDevice() override;
+    int_type underflow() override;
+
+    std::streamsize xsgetn(char_type* buffer, std::streamsize size) override;
+
+    std::streamsize showmanyc() override;
+
+    pos_type seekoff(off_type offset,
+                     std::ios_base::seekdir direction,
+                     std::ios_base::openmode which = std::ios_base::in) override;
+
+    pos_type seekpos(pos_type position,
+                     std::ios_base::openmode which = std::ios_base::in) override;
 
 private:
-    ByteBufferReader _bufferReader;
+    ByteBufferInputStreamBuf(const ByteBufferInputStreamBuf&);
+    ByteBufferInputStreamBuf& operator = (const ByteBufferInputStreamBuf&);
+
+    /// \brief Expose a view as the get area.
+    /// \param view The bytes to read.
+    /// \param offset The read position, clamped to the size of the view.
+    void _setView(const ByteBufferView& view, std::size_t offset);
 
 };
 
@@ -63,6 +92,12 @@ public:
         poco_ios_init(&_buf);
     }
 
+    ByteBufferInputIOS(const ByteBufferView& buffer, std::size_t offset = 0):
+        _buf(buffer, offset)
+    {
+        poco_ios_init(&_buf);
+    }
+
 protected:
     ByteBufferInputStreamBuf _buf;
 
@@ -77,23 +112,63 @@ public:
         std::istream(&_buf)
     {
     }
+
+    ByteBufferInputStream(const ByteBufferView& buffer, std::size_t offset = 0):
+        ByteBufferInputIOS(buffer, offset),
+        std::istream(&_buf)
+    {
+    }
 };
 
 
 
-class ByteBufferOutputStreamBuf: public Poco::UnbufferedStreamBuf
+/// \brief A stream buffer that appends to a ByteBuffer.
+///
+/// Small writes are collected in a put area and appended to the ByteBuffer
+/// in blocks.  Writes larger than the put area are appended directly.  The
+/// ByteBuffer is only guaranteed to hold all written bytes after the stream
+/// is flushed or destroyed:
+///
+///     ByteBufferOutputStream ostr(buffer);
+///     ostr << value << std::flush;
+///     // buffer now holds the formatted value.
+///
+/// The put area is owned by the stream buffer rather than placed in the
+/// ByteBuffer's spare capacity, so the ByteBuffer may be used and grown
+/// between writes without invalidating bytes that are not yet flushed.
+class ByteBufferOutputStreamBuf: public std::streambuf
 {
 public:
     ByteBufferOutputStreamBuf(ByteBuffer& buffer);
 
     virtual ~ByteBufferOutputStreamBuf();
 
+    enum
+    {
+        /// \brief The size of the put area.
+        DEFAULT_BUFFER_SIZE = 8192
+    };
+
 protected:
-    int writeToDevice(char byte) override;
+    int_type overflow(int_type c) override;
+
+    std::streamsize xsputn(const char_type* buffer, std::streamsize size) override;
+
+    int sync() override;
 
 private:
+    ByteBufferOutputStreamBuf(const ByteBufferOutputStreamBuf&);
+    ByteBufferOutputStreamBuf& operator = (const ByteBufferOutputStreamBuf&);
+
+    /// \brief Append the put area to the ByteBuffer and empty it.
+    void _flush();
+
+    /// \brief The ByteBuffer to append to.
     ByteBuffer& _buffer;
-    
+
+    /// \brief The put area.
+    char _block[DEFAULT_BUFFER_SIZE];
+
 };
 
 
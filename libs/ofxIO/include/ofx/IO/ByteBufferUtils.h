@@ -26,7 +26,9 @@
 #pragma once
 
 
+#include <functional>
 #include <iostream>
+#include <string>
 #include <stdint.h>
 
 
@@ -34,7 +36,9 @@ namespace ofx {
 namespace IO {
 
 
+class AbstractByteSource;
 class ByteBuffer;
+class ByteBufferView;
 
 
 /// \brief Utilities for use with ByteBuffer.
@@ -104,13 +108,38 @@ public:
     static std::ostream& copyBufferToStream(const ByteBuffer& byteBuffer,
                                             std::ostream& ostr);
 
+    /// \brief Copy a ByteBufferView to an output stream.
+    /// \param view the ByteBufferView to copy.
+    /// \param ostr the target output stream.
+    /// \returns The passed output stream.
+    static std::ostream& copyBufferToStream(const ByteBufferView& view,
+                                            std::ostream& ostr);
+
+    /// \brief Copy a byte source to an output stream.
+    ///
+    /// Contiguous chunks of the source are written directly.  The source is
+    /// only copied if it does not expose its chunks.
+    ///
+    /// \param source the AbstractByteSource to copy.
+    /// \param ostr the target output stream.
+    /// \returns The passed output stream.
+    static std::ostream& copyBufferToStream(const AbstractByteSource& source,
+                                            std::ostream& ostr);
+
     /// \brief Load a ByteBuffer from a file.
+    ///
+    /// On POSIX systems the file size is queried first, the buffer is grown
+    /// once and the file is read with a few large read() calls.  The stream
+    /// is used on other platforms, or when std::ios::ate is requested.
     ///
 	/// Files are always opened in binary mode, a text mode with CR-LF
     /// translation is not supported. Thus, the file is always opened as if the
     /// std::ios::binary flag was specified. Use a
     /// Poco::InputLineEndingConverter if you require CR-LF translation.
     ///
+    /// To process a large file without copying it into memory, use a
+    /// MappedByteBuffer instead.
+    ///
     /// \param path The absolute path of the file to load.
     /// \param buffer the target ByteBuffer to fill.
     /// \param appendBuffer false if the ByteBuffer should be cleared.
@@ -124,6 +153,44 @@ public:
                                         std::ios::openmode openMode = std::ios::in);
 
 
+    /// \brief A callback for each chunk loaded by loadFromFileParallel().
+    ///
+    /// The first argument is the offset of the chunk in the file and the
+    /// second is a view of the loaded bytes.
+    typedef std::function<void(std::size_t, const ByteBufferView&)> ChunkCallback;
+
+    /// \brief Load a large file with concurrent reads.
+    ///
+    /// The ByteBuffer is sized once, the file is split into page-aligned
+    /// chunks and a pool of threads reads the chunks directly into place with
+    /// pread().  If a callback is given, it is called for each chunk as soon
+    /// as it is loaded, so processing overlaps with loading the remaining
+    /// chunks.
+    ///
+    /// The callback is called from the loading threads, concurrently and in
+    /// no particular order.  If it throws, loading stops and the exception is
+    /// rethrown to the caller.
+    ///
+    /// Empty files and files that are not regular files are loaded with
+    /// loadFromFile().
+    ///
+    /// \param path The path of the file to load.
+    /// \param buffer The target ByteBuffer to fill.
+    /// \param callback An optional function to call for each loaded chunk.
+    /// \param chunkSize The number of bytes in each chunk.  It is rounded up
+    ///        to a multiple of the page size.
+    /// \param numThreads The number of loading threads, or 0 for one per
+    ///        hardware thread.
+    /// \returns The total number of bytes loaded.
+    /// \throws Poco::FileNotFoundException (or a similar exception) if the
+    ///         file cannot be opened, and Poco::ReadFileException if a read
+    ///         fails or the file shrinks while loading.
+    static std::size_t loadFromFileParallel(const std::string& path,
+                                            ByteBuffer& buffer,
+                                            const ChunkCallback& callback = ChunkCallback(),
+                                            std::size_t chunkSize = DEFAULT_CHUNK_SIZE,
+                                            std::size_t numThreads = 0);
+
     /// \brief Save a ByteBuffer as a file.
     /// \param buffer the target ByteBuffer to save.
     /// \param path The absolute path of the file to save.
@@ -136,12 +203,81 @@ public:
                            const std::string& path,
                            std::ios::openmode mode = std::ios::out | std::ios::trunc);
 
+    /// \brief Options for writeToFile().
+    enum SaveOptions
+    {
+        /// \brief Truncate and overwrite the file in place.
+        SAVE_DEFAULT = 0,
+        /// \brief Write a temporary file in the same directory and rename it
+        ///        over the target, so readers see either the old or the new
+        ///        contents and never a partially written file.
+        SAVE_ATOMIC = 1 << 0,
+        /// \brief Flush the file and, if the file was created or renamed,
+        ///        its directory to stable storage before returning.
+        SAVE_DURABLE = 1 << 1,
+        /// \brief Allocate the file's full size before writing, to reduce
+        ///        fragmentation and fail early if the disk is full.
+        SAVE_PREALLOCATE = 1 << 2
+    };
+
+    /// \brief Write a byte source to a file with write()/writev().
+    ///
+    /// This is distinct from saveToFile() so that a ByteBuffer with
+    /// SaveOptions can never be taken for a std::ios::openmode.
+    ///
+    /// The bytes are written directly from the source's contiguous chunks
+    /// without an iostream layer.  A ChainedByteBuffer is written with a
+    /// single writev() for up to IOV_MAX segments at a time.
+    ///
+    /// A file replaced with SAVE_ATOMIC keeps its permissions.
+    ///
+    /// \param source the bytes to save.
+    /// \param path The path of the file to save.
+    /// \param options A combination of SaveOptions.
+    /// \returns True iff the file was saved successfully.
+    /// \throws Poco::CreateFileException if the file cannot be created and
+    ///         Poco::WriteFileException if it or its directory cannot be
+    ///         written, synced or renamed.  The target is unchanged if
+    ///         SAVE_ATOMIC is set and the rename did not happen.
+    /// \throws Poco::NotImplementedException if SAVE_ATOMIC or SAVE_DURABLE is
+    ///         requested on a platform without POSIX file I/O.
+    static bool writeToFile(const AbstractByteSource& source,
+                            const std::string& path,
+                            int options = SAVE_DEFAULT);
+
     enum
     {
         /// \brief The default buffer size for use during buffered copies.
-        DEFAULT_BUFFER_SIZE = 8192
+        DEFAULT_BUFFER_SIZE = 8192,
+        /// \brief The default chunk size for loadFromFileParallel().
+        DEFAULT_CHUNK_SIZE = 8 * 1024 * 1024
     };
 
+private:
+    /// \brief Append the remaining contents of a file descriptor.
+    /// \param fd The open file descriptor.
+    /// \param byteBuffer The target ByteBuffer.
+    /// \returns The total number of bytes appended.
+    /// \throws Poco::ReadFileException if the read fails.
+    static std::streamsize _loadFromFileDescriptor(int fd,
+                                                   ByteBuffer& byteBuffer);
+
+    /// \brief Write all bytes of a source to a file descriptor.
+    /// \param fd The open file descriptor.
+    /// \param source The bytes to write.
+    /// \returns The total number of bytes written.
+    /// \throws Poco::WriteFileException if a write fails.
+    static std::size_t _writeToFileDescriptor(int fd,
+                                              const AbstractByteSource& source);
+
+    /// \brief Flush a directory's entries to stable storage.
+    /// \param directory The path of the directory.
+    /// \param path The path reported if the flush fails.
+    /// \throws Poco::WriteFileException if the directory cannot be opened or
+    ///         synced.
+    static void _syncDirectory(const std::string& directory,
+                               const std::string& path);
+
 };
 
 
@@ -0,0 +1,150 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "ofx/IO/AbstractTypes.h"
+#include "ofx/IO/ByteBufferUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A non-owning, read-only view of a contiguous range of bytes.
+///
+/// A ByteBufferView is a pointer and a length.  It never copies or owns the
+/// bytes it refers to, so slices of a larger buffer can be passed to any API
+/// that accepts a ByteBufferView without copying.  A ByteBuffer is implicitly
+/// convertible to a ByteBufferView.
+///
+/// \warning The referenced bytes must outlive the view.  Resizing or
+///          destroying the backing ByteBuffer invalidates the view.
+class ByteBufferView: public AbstractByteSource
+{
+public:
+    /// \brief Construct an empty ByteBufferView.
+    ByteBufferView();
+
+    /// \brief Construct a ByteBufferView from a byte array.
+    /// \param buffer is an array of bytes.
+    /// \param size is the number of bytes in the buffer.
+    ByteBufferView(const uint8_t* buffer, std::size_t size);
+
+    /// \brief Construct a ByteBufferView from a char array.
+    /// \param buffer is an array of bytes.
+    /// \param size is the number of bytes in the buffer.
+    ByteBufferView(const char* buffer, std::size_t size);
+
+    /// \brief Construct a ByteBufferView of an entire ByteBuffer.
+    /// \param buffer is the ByteBuffer to view.
+    ByteBufferView(const ByteBuffer& buffer);
+
+    /// \brief Construct a ByteBufferView of a range of a ByteBuffer.
+    ///
+    /// The range is clamped to the bounds of the buffer.
+    ///
+    /// \param buffer is the ByteBuffer to view.
+    /// \param offset is the index of the first byte in the view.
+    /// \param size is the maximum number of bytes in the view.
+    ByteBufferView(const ByteBuffer& buffer,
+                   std::size_t offset,
+                   std::size_t size);
+
+    /// \brief Destroy the ByteBufferView.
+    virtual ~ByteBufferView();
+
+    virtual std::size_t readBytes(uint8_t* buffer, std::size_t size) const override;
+    virtual std::size_t readBytes(std::vector<uint8_t>& buffer) const override;
+    virtual std::size_t readBytes(std::string& buffer) const override;
+    virtual std::size_t readBytes(AbstractByteSink& buffer) const override;
+    virtual std::vector<uint8_t> readBytes() const override;
+    virtual const uint8_t* getContiguousPtr() const override;
+
+    /// \brief Query the number of bytes in the ByteBufferView.
+    /// \returns the number of bytes in the ByteBufferView.
+    std::size_t size() const override;
+
+    /// \brief Determine if the ByteBufferView is empty.
+    /// \returns true iff the number of bytes in the ByteBufferView is 0.
+    bool empty() const;
+
+    /// \param n is the element index in the ByteBufferView.
+    ///
+    /// The value of n should not exceed size() - 1.
+    ///
+    /// \returns a copy of the byte at position n in the ByteBufferView.
+    uint8_t operator [] (std::size_t n) const;
+
+    /// \brief Get a const pointer to the viewed bytes.
+    /// \returns a const pointer to the viewed bytes or nullptr if empty.
+    const uint8_t* getPtr() const;
+
+    /// \brief Get a const char pointer to the viewed bytes.
+    /// \returns a const char pointer to the viewed bytes or nullptr if empty.
+    const char* getCharPtr() const;
+
+    /// \brief Get a view of a range of this view.
+    ///
+    /// The range is clamped to the bounds of this view.
+    ///
+    /// \param offset is the index of the first byte in the new view.
+    /// \param size is the maximum number of bytes in the new view.
+    /// \returns a view of the requested range.
+    ByteBufferView subview(std::size_t offset, std::size_t size) const;
+
+    /// \brief get the ByteBufferView as a std::string.
+    /// \returns a std::string copy of the viewed bytes.
+    std::string toString() const;
+
+    /// \brief Write the viewed bytes to an output stream.
+    /// \param ostr The std::ostream to write to.
+    /// \param view the ByteBufferView to write.
+    /// \returns the std::ostream that was written to.
+    friend std::ostream& operator << (std::ostream& ostr,
+                                      const ByteBufferView& view);
+
+private:
+    /// \brief A pointer to the first viewed byte.
+    const uint8_t* _data;
+
+    /// \brief The number of viewed bytes.
+    std::size_t _size;
+
+};
+
+
+inline std::ostream& operator << (std::ostream& ostr,
+                                  const ByteBufferView& view)
+{
+    return ByteBufferUtils::copyBufferToStream(view, ostr);
+}
+
+
+} }  // namespace ofx::IO
@@ -28,6 +28,8 @@
 
 #include <type_traits>
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteOrder.h"
+#include "ofx/IO/VarintEncoding.h"
 
 
 namespace ofx {
@@ -35,14 +37,39 @@ namespace IO {
 
 
 /// \brief An interface for writing data of various byte widths.
+///
+/// By default a ByteBufferWriter only overwrites bytes within the current size
+/// of its ByteBuffer.  With GROWTH_GEOMETRIC, writes past the end extend the
+/// ByteBuffer instead, doubling its capacity as needed, so a message of
+/// unknown length can be serialized without sizing the buffer first.
 class ByteBufferWriter
 {
 public:
+    /// \brief The behavior when a write does not fit in the ByteBuffer.
+    enum GrowthPolicy
+    {
+        /// \brief Fail the write and return 0.
+        GROWTH_NONE,
+        /// \brief Extend the ByteBuffer, growing its capacity geometrically.
+        GROWTH_GEOMETRIC
+    };
+
     /// \brief Create a ByteBufferWriter.
     /// \param buffer A reference to a ByteBuffer to write into.
     /// \param offset The offset to write from.
     ByteBufferWriter(ByteBuffer& buffer, std::size_t offset = 0);
 
+    /// \brief Create a ByteBufferWriter with a growth policy.
+    /// \param buffer A reference to a ByteBuffer to write into.
+    /// \param offset The offset to write from.
+    /// \param policy The behavior when a write does not fit.
+    /// \param reserveHint The number of bytes expected to be written.  The
+    ///        ByteBuffer capacity is reserved for them up front.
+    ByteBufferWriter(ByteBuffer& buffer,
+                     std::size_t offset,
+                     GrowthPolicy policy,
+                     std::size_t reserveHint = 0);
+
     /// \brief Write a single data into the ByteBuffer.
     ///
     /// This function accepts "Plain Old Data" types and uses the sizeof()
@@ -72,6 +99,102 @@ public:
     template <typename Type>
     std::size_t write(const Type* data, std::size_t size);
 
+    /// \brief Write a value into the ByteBuffer in big-endian order.
+    /// \param data The value to write in host byte order.
+    /// \returns The number of bytes written.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    template <typename Type>
+    std::size_t writeBE(const Type& data);
+
+    /// \brief Write a value into the ByteBuffer in little-endian order.
+    /// \param data The value to write in host byte order.
+    /// \returns The number of bytes written.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    template <typename Type>
+    std::size_t writeLE(const Type& data);
+
+    /// \brief Write an array into the ByteBuffer in big-endian order.
+    /// \param data The array of values in host byte order.
+    /// \param size The length of the array.
+    /// \returns The number of bytes written.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    template <typename Type>
+    std::size_t writeBE(const Type* data, std::size_t size);
+
+    /// \brief Write an array into the ByteBuffer in little-endian order.
+    /// \param data The array of values in host byte order.
+    /// \param size The length of the array.
+    /// \returns The number of bytes written.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    template <typename Type>
+    std::size_t writeLE(const Type* data, std::size_t size);
+
+    /// \brief Write an unsigned integer into the ByteBuffer as a varint.
+    /// \param data The value to write.
+    /// \returns The number of bytes written.
+    /// \tparam Type An unsigned integral type.
+    template <typename Type>
+    std::size_t writeVarint(const Type& data);
+
+    /// \brief Write an array of unsigned integers into the ByteBuffer as
+    ///        varints.
+    ///
+    /// Nothing is written unless there is room for every value.
+    ///
+    /// \param data The array to write.
+    /// \param size The length of the array.
+    /// \returns The number of bytes written.
+    /// \tparam Type An unsigned integral type.
+    template <typename Type>
+    std::size_t writeVarint(const Type* data, std::size_t size);
+
+    /// \brief Write a signed integer into the ByteBuffer as a zigzag varint.
+    /// \param data The value to write.
+    /// \returns The number of bytes written.
+    /// \tparam Type A signed integral type.
+    template <typename Type>
+    std::size_t writeZigZag(const Type& data);
+
+    /// \brief Write an array of signed integers into the ByteBuffer as
+    ///        zigzag varints.
+    ///
+    /// Nothing is written unless there is room for every value.
+    ///
+    /// \param data The array to write.
+    /// \param size The length of the array.
+    /// \returns The number of bytes written.
+    /// \tparam Type A signed integral type.
+    template <typename Type>
+    std::size_t writeZigZag(const Type* data, std::size_t size);
+
+    /// \brief Get a pointer for writing bytes in place.
+    ///
+    /// The returned pointer addresses the current offset and is valid for
+    /// size bytes, growing the ByteBuffer if the policy allows.  The offset
+    /// is not advanced; call commitBytes() with the number of bytes actually
+    /// produced.  Any further write or reservation invalidates the pointer.
+    ///
+    /// \param size The number of bytes to reserve.
+    /// \returns a writable pointer or nullptr if there is no room.
+    uint8_t* reserveBytes(std::size_t size);
+
+    /// \brief Advance the offset past bytes written in place.
+    ///
+    /// With GROWTH_GEOMETRIC, a ByteBuffer extended by reserveBytes() is
+    /// trimmed back to the committed bytes.
+    ///
+    /// \param size The number of bytes produced since reserveBytes().
+    /// \returns The number of bytes committed, which is 0 if size exceeds the
+    ///     bytes available.
+    std::size_t commitBytes(std::size_t size);
+
+    /// \brief Set the growth policy.
+    /// \param policy The behavior when a write does not fit.
+    void setGrowthPolicy(GrowthPolicy policy);
+
+    /// \returns the growth policy.
+    GrowthPolicy getGrowthPolicy() const;
+
     /// \brief Set the write offset to a given byte.
     ///
     /// Will set the offset past the end of the buffer.
@@ -92,17 +215,51 @@ private:
     ByteBufferWriter(const ByteBufferWriter& that);
     ByteBufferWriter& operator = (const ByteBufferWriter& that);
 
+    /// \brief Make room for bytes at the current offset.
+    /// \param size The number of bytes to make room for.
+    /// \returns a pointer to the current offset or nullptr if there is no
+    ///     room and the buffer may not grow.
+    uint8_t* _prepare(std::size_t size);
+
     /// \brief The proxy writer function.
     /// \param source The byte source.
     /// \param size The number of bytes to write.
     /// \returns The number of bytes written.
     std::size_t _write(const void* source, std::size_t size);
 
+    /// \brief The proxy writer function for values in a given byte order.
+    /// \param source The values in host byte order.
+    /// \param count The number of values to write.
+    /// \param width The number of bytes in each value.
+    /// \param flip true if the bytes of each value should be reversed.
+    /// \returns The number of bytes written.
+    std::size_t _writeOrdered(const void* source,
+                              std::size_t count,
+                              std::size_t width,
+                              bool flip);
+
+    /// \brief The proxy writer function for varints.
+    /// \param data The values to write.
+    /// \param size The number of values to write.
+    /// \returns The number of bytes written.
+    template <typename Type>
+    std::size_t _writeVarints(const Type* data, std::size_t size);
+
     /// \brief A reference to the target buffer.
     ByteBuffer& _buffer;
 
     /// \brief The current write offset.
     std::size_t _offset;
+
+    /// \brief The behavior when a write does not fit.
+    GrowthPolicy _policy;
+
+    /// \brief The size of the buffer before reserveBytes() extended it, or
+    ///        NO_RESERVATION.
+    std::size_t _reserveStart;
+
+    /// \brief Marks that no reservation is pending.
+    static const std::size_t NO_RESERVATION = static_cast<std::size_t>(-1);
     
 };
 
@@ -123,4 +280,108 @@ std::size_t ByteBufferWriter::write(const Type* data, std::size_t size)
 }
 
 
+template <typename Type>
+std::size_t ByteBufferWriter::writeBE(const Type& data)
+{
+    return writeBE(&data, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeLE(const Type& data)
+{
+    return writeLE(&data, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeBE(const Type* data, std::size_t size)
+{
+    static_assert(std::is_arithmetic<Type>::value || std::is_enum<Type>::value,
+                  "Type must be an arithmetic or enum type.");
+    static_assert(sizeof(Type) == 1 || sizeof(Type) == 2 ||
+                  sizeof(Type) == 4 || sizeof(Type) == 8,
+                  "Type must be 1, 2, 4 or 8 bytes.");
+    return _writeOrdered(data,
+                         size,
+                         sizeof(Type),
+                         ByteOrder::isLittleEndian());
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeLE(const Type* data, std::size_t size)
+{
+    static_assert(std::is_arithmetic<Type>::value || std::is_enum<Type>::value,
+                  "Type must be an arithmetic or enum type.");
+    static_assert(sizeof(Type) == 1 || sizeof(Type) == 2 ||
+                  sizeof(Type) == 4 || sizeof(Type) == 8,
+                  "Type must be 1, 2, 4 or 8 bytes.");
+    return _writeOrdered(data,
+                         size,
+                         sizeof(Type),
+                         ByteOrder::isBigEndian());
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeVarint(const Type& data)
+{
+    return writeVarint(&data, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeVarint(const Type* data, std::size_t size)
+{
+    static_assert(std::is_integral<Type>::value && std::is_unsigned<Type>::value,
+                  "Type must be an unsigned integral type.");
+    return _writeVarints(data, size);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeZigZag(const Type& data)
+{
+    return writeZigZag(&data, 1);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::writeZigZag(const Type* data, std::size_t size)
+{
+    static_assert(std::is_integral<Type>::value && std::is_signed<Type>::value,
+                  "Type must be a signed integral type.");
+    return _writeVarints(data, size);
+}
+
+
+template <typename Type>
+std::size_t ByteBufferWriter::_writeVarints(const Type* data, std::size_t size)
+{
+    std::size_t total = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        total += VarintEncoding::encodedSize(VarintEncoding::fromInteger(data[i]));
+    }
+
+    uint8_t* destination = _prepare(total);
+
+    if (destination == nullptr)
+    {
+        return 0;
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        destination += VarintEncoding::encode(VarintEncoding::fromInteger(data[i]),
+                                              destination);
+    }
+
+    _offset += total;
+    return total;
+}
+
+
 } } // namespace ofx::IO
@@ -0,0 +1,399 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include "Poco/Platform.h"
+
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Utilities for converting values between host and wire byte order.
+///
+/// Scalar conversions compile to a single byte-swap instruction, or to nothing
+/// when the host order already matches.  The array conversions use SIMD
+/// shuffles when the target supports them and are safe to use in place.
+class ByteOrder
+{
+public:
+    /// \brief A byte order for encoded values.
+    enum Endianness
+    {
+        /// \brief Most significant byte first, e.g. network byte order.
+        ENDIAN_BIG,
+        /// \brief Least significant byte first.
+        ENDIAN_LITTLE,
+        /// \brief The byte order of the host.
+        ENDIAN_HOST
+    };
+
+    /// \brief The order of bits within each byte of a bit stream.
+    enum BitOrder
+    {
+        /// \brief The first bit is the most significant bit of a byte.
+        BIT_ORDER_MSB_FIRST,
+        /// \brief The first bit is the least significant bit of a byte.
+        BIT_ORDER_LSB_FIRST
+    };
+
+    /// \brief Determine if values must be flipped to convert between host
+    ///        byte order and a given byte order.
+    /// \param order The byte order of the encoded values.
+    /// \returns true iff the order differs from the host byte order.
+    static bool needsFlip(Endianness order);
+
+    /// \returns true iff the host stores values most significant byte first.
+    static bool isBigEndian();
+
+    /// \returns true iff the host stores values least significant byte first.
+    static bool isLittleEndian();
+
+    /// \brief Reverse the bytes of a value.
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    /// \param value The value to convert.
+    /// \returns the value with its bytes reversed.
+    template <typename Type>
+    static Type flipBytes(Type value);
+
+    /// \brief Reverse the bytes of each value in an array.
+    ///
+    /// The destination may be the same as the source, but the two must not
+    /// otherwise overlap.
+    ///
+    /// \tparam Type An arithmetic or enum type of 1, 2, 4 or 8 bytes.
+    /// \param destination The array to fill with converted values.
+    /// \param source The array of values to convert.
+    /// \param count The number of values in each array.
+    template <typename Type>
+    static void flipBytes(Type* destination,
+                          const Type* source,
+                          std::size_t count);
+
+    /// \brief Convert a value between host and big-endian order.
+    /// \param value The value to convert.
+    /// \returns the converted value.
+    template <typename Type>
+    static Type toBigEndian(Type value);
+
+    /// \brief Convert a value between big-endian and host order.
+    /// \param value The value to convert.
+    /// \returns the converted value.
+    template <typename Type>
+    static Type fromBigEndian(Type value);
+
+    /// \brief Convert a value between host and little-endian order.
+    /// \param value The value to convert.
+    /// \returns the converted value.
+    template <typename Type>
+    static Type toLittleEndian(Type value);
+
+    /// \brief Convert a value between little-endian and host order.
+    /// \param value The value to convert.
+    /// \returns the converted value.
+    template <typename Type>
+    static Type fromLittleEndian(Type value);
+
+    /// \brief Convert an array between host and big-endian order.
+    ///
+    /// The destination may be the same as the source, but the two must not
+    /// otherwise overlap.
+    ///
+    /// \param destination The array to fill with converted values.
+    /// \param source The array of values to convert.
+    /// \param count The number of values in each array.
+    template <typename Type>
+    static void convertBigEndian(Type* destination,
+                                 const Type* source,
+                                 std::size_t count);
+
+    /// \brief Convert an array between host and little-endian order.
+    ///
+    /// The destination may be the same as the source, but the two must not
+    /// otherwise overlap.
+    ///
+    /// \param destination The array to fill with converted values.
+    /// \param source The array of values to convert.
+    /// \param count The number of values in each array.
+    template <typename Type>
+    static void convertLittleEndian(Type* destination,
+                                    const Type* source,
+                                    std::size_t count);
+
+    /// \brief Reverse the bytes of each 16-bit value in an array.
+    /// \param destination The array to fill with converted values.
+    /// \param source The array of values to convert.
+    /// \param count The number of 16-bit values in each array.
+    static void flipBytes16(void* destination,
+                            const void* source,
+                            std::size_t count);
+
+    /// \brief Reverse the bytes of each 32-bit value in an array.
+    /// \param destination The array to fill with converted values.
+    /// \param source The array of values to convert.
+    /// \param count The number of 32-bit values in each array.
+    static void flipBytes32(void* destination,
+                            const void* source,
+                            std::size_t count);
+
+    /// \brief Reverse the bytes of each 64-bit value in an array.
+    /// \param destination The array to fill with converted values.
+    /// \param source The array of values to convert.
+    /// \param count The number of 64-bit values in each array.
+    static void flipBytes64(void* destination,
+                            const void* source,
+                            std::size_t count);
+
+    /// \brief Reverse the bytes of an unsigned integer.
+    static uint8_t flip(uint8_t value);
+
+    /// \brief Reverse the bytes of an unsigned integer.
+    static uint16_t flip(uint16_t value);
+
+    /// \brief Reverse the bytes of an unsigned integer.
+    static uint32_t flip(uint32_t value);
+
+    /// \brief Reverse the bytes of an unsigned integer.
+    static uint64_t flip(uint64_t value);
+
+private:
+    /// \brief The unsigned integer type with the same size as a value.
+    template <std::size_t Size> struct UnsignedType;
+
+    template <typename Type>
+    static void _checkType();
+
+    static void _flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 1>);
+
+    static void _flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 2>);
+
+    static void _flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 4>);
+
+    static void _flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 8>);
+
+};
+
+
+template <> struct ByteOrder::UnsignedType<1> { typedef uint8_t type; };
+template <> struct ByteOrder::UnsignedType<2> { typedef uint16_t type; };
+template <> struct ByteOrder::UnsignedType<4> { typedef uint32_t type; };
+template <> struct ByteOrder::UnsignedType<8> { typedef uint64_t type; };
+
+
+inline bool ByteOrder::isBigEndian()
+{
+#if defined(POCO_ARCH_BIG_ENDIAN)
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+inline bool ByteOrder::isLittleEndian()
+{
+    return !isBigEndian();
+}
+
+
+inline bool ByteOrder::needsFlip(Endianness order)
+{
+    return (order == ENDIAN_BIG && isLittleEndian()) ||
+           (order == ENDIAN_LITTLE && isBigEndian());
+}
+
+
+inline uint8_t ByteOrder::flip(uint8_t value)
+{
+    return value;
+}
+
+
+inline uint16_t ByteOrder::flip(uint16_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap16(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(value);
+#else
+    return static_cast<uint16_t>((value << 8) | (value >> 8));
+#endif
+}
+
+
+inline uint32_t ByteOrder::flip(uint32_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap32(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return ((value << 24) & 0xFF000000) |
+           ((value <<  8) & 0x00FF0000) |
+           ((value >>  8) & 0x0000FF00) |
+           ((value >> 24) & 0x000000FF);
+#endif
+}
+
+
+inline uint64_t ByteOrder::flip(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap64(value);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return (static_cast<uint64_t>(flip(static_cast<uint32_t>(value))) << 32) |
+            flip(static_cast<uint32_t>(value >> 32));
+#endif
+}
+
+
+template <typename Type>
+void ByteOrder::_checkType()
+{
+    static_assert(std::is_arithmetic<Type>::value || std::is_enum<Type>::value,
+                  "Type must be an arithmetic or enum type.");
+    static_assert(sizeof(Type) == 1 || sizeof(Type) == 2 ||
+                  sizeof(Type) == 4 || sizeof(Type) == 8,
+                  "Type must be 1, 2, 4 or 8 bytes.");
+}
+
+
+template <typename Type>
+Type ByteOrder::flipBytes(Type value)
+{
+    _checkType<Type>();
+    typename UnsignedType<sizeof(Type)>::type bits;
+    std::memcpy(&bits, &value, sizeof(Type));
+    bits = flip(bits);
+    std::memcpy(&value, &bits, sizeof(Type));
+    return value;
+}
+
+
+template <typename Type>
+void ByteOrder::flipBytes(Type* destination,
+                          const Type* source,
+                          std::size_t count)
+{
+    _checkType<Type>();
+    _flipBytes(destination,
+               source,
+               count,
+               std::integral_constant<std::size_t, sizeof(Type)>());
+}
+
+
+template <typename Type>
+Type ByteOrder::toBigEndian(Type value)
+{
+    return isBigEndian() ? value : flipBytes(value);
+}
+
+
+template <typename Type>
+Type ByteOrder::fromBigEndian(Type value)
+{
+    return toBigEndian(value);
+}
+
+
+template <typename Type>
+Type ByteOrder::toLittleEndian(Type value)
+{
+    return isLittleEndian() ? value : flipBytes(value);
+}
+
+
+template <typename Type>
+Type ByteOrder::fromLittleEndian(Type value)
+{
+    return toLittleEndian(value);
+}
+
+
+template <typename Type>
+void ByteOrder::convertBigEndian(Type* destination,
+                                 const Type* source,
+                                 std::size_t count)
+{
+    if (isBigEndian())
+    {
+        if (destination != source && count > 0)
+        {
+            std::memcpy(destination, source, sizeof(Type) * count);
+        }
+    }
+    else
+    {
+        flipBytes(destination, source, count);
+    }
+}
+
+
+template <typename Type>
+void ByteOrder::convertLittleEndian(Type* destination,
+                                    const Type* source,
+                                    std::size_t count)
+{
+    if (isLittleEndian())
+    {
+        if (destination != source && count > 0)
+        {
+            std::memcpy(destination, source, sizeof(Type) * count);
+        }
+    }
+    else
+    {
+        flipBytes(destination, source, count);
+    }
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,130 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "ofx/IO/AbstractTypes.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A lock-free, fixed-capacity single-producer / single-consumer byte
+///        ring buffer.
+///
+/// One thread (the producer) writes bytes using the AbstractByteSink
+/// interface and one thread (the consumer) reads them using the
+/// AbstractBufferedByteSource interface.  Neither side ever blocks, locks or
+/// allocates.  Writes store as many bytes as there is room for and reads
+/// return as many bytes as are available.
+///
+/// The producer and consumer indices are kept on separate cache lines, and
+/// each side caches the other side's index so that the shared indices are
+/// only read when the cached value says the buffer is full / empty.
+///
+/// \warning Only one thread may write and only one thread may read.
+class ByteRingBuffer: public AbstractBufferedByteSource, public AbstractByteSink
+{
+public:
+    /// \brief Create a ByteRingBuffer.
+    /// \param capacity The minimum capacity in bytes.  This is rounded up to
+    ///        the next power of two.
+    /// \throws Poco::InvalidArgumentException if the capacity cannot be
+    ///         rounded up to a power of two.
+    explicit ByteRingBuffer(std::size_t capacity = DEFAULT_CAPACITY);
+
+    /// \brief Destroy the ByteRingBuffer.
+    virtual ~ByteRingBuffer();
+
+    /// \brief Read a single byte.  Consumer only.
+    std::size_t readByte(uint8_t& data) override;
+
+    /// \brief Read up to size bytes.  Consumer only.
+    std::size_t readBytes(uint8_t* buffer, std::size_t size) override;
+
+    /// \brief Query the number of bytes that can be read.
+    std::size_t available() const override;
+
+    /// \brief Write a single byte.  Producer only.
+    std::size_t writeByte(uint8_t data) override;
+
+    /// \brief Write up to size bytes.  Producer only.
+    std::size_t writeBytes(const uint8_t* buffer, std::size_t size) override;
+
+    /// \brief Write up to buffer.size() bytes.  Producer only.
+    std::size_t writeBytes(const std::vector<uint8_t>& buffer) override;
+
+    /// \brief Write up to buffer.size() bytes.  Producer only.
+    std::size_t writeBytes(const std::string& buffer) override;
+
+    /// \brief Write up to buffer.size() bytes.  Producer only.
+    std::size_t writeBytes(const AbstractByteSource& buffer) override;
+
+    /// \brief Query the number of bytes that can be written.
+    std::size_t freeSpace() const;
+
+    /// \returns the capacity in bytes.
+    std::size_t capacity() const;
+
+    enum
+    {
+        /// \brief The default capacity in bytes.
+        DEFAULT_CAPACITY = 65536,
+
+        /// \brief The assumed cache line size used to separate the indices.
+        CACHE_LINE_SIZE = 64
+    };
+
+private:
+    ByteRingBuffer(const ByteRingBuffer& that);
+    ByteRingBuffer& operator = (const ByteRingBuffer& that);
+
+    /// \brief The backing storage.
+    std::vector<uint8_t> _buffer;
+
+    /// \brief The capacity - 1, used to wrap indices.
+    std::size_t _mask;
+
+    /// \brief The total number of bytes written.  Written by the producer.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _writeIndex;
+
+    /// \brief The producer's cached copy of _readIndex.
+    std::size_t _cachedReadIndex;
+
+    /// \brief The total number of bytes read.  Written by the consumer.
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _readIndex;
+
+    /// \brief The consumer's cached copy of _writeIndex.
+    std::size_t _cachedWriteIndex;
+
+};
+
+
+} }  // namespace ofx::IO
@@ -0,0 +1,223 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ofx/IO/AbstractTypes.h"
+#include "ofx/IO/ByteBuffer.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A byte buffer made of a chain of reference-counted segments.
+///
+/// Unlike a ByteBuffer, appending to a ChainedByteBuffer never moves the bytes
+/// that are already stored.  Written bytes are copied into fixed-capacity
+/// segments and a new segment is started when the last one is full.  Existing
+/// buffers can be appended or prepended in O(1) by sharing them rather than
+/// copying them.
+///
+/// The bytes are only copied into a single contiguous segment when a
+/// contiguous pointer is explicitly requested with getPtr() or coalesce().
+/// Sinks that support AbstractByteSource::getChunk() read the segments
+/// directly.
+///
+/// \note Shared segments are never modified, but a ChainedByteBuffer is not
+///       thread-safe.
+class ChainedByteBuffer: public AbstractByteSource, public AbstractByteSink
+{
+public:
+    /// \brief A shared, immutable segment buffer.
+    typedef std::shared_ptr<const ByteBuffer> SharedByteBuffer;
+
+    /// \brief Construct an empty ChainedByteBuffer.
+    /// \param segmentSize is the minimum capacity of segments allocated
+    ///        to hold written bytes.
+    explicit ChainedByteBuffer(std::size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+    /// \brief Copy a ChainedByteBuffer by sharing its segments.
+    ///
+    /// Neither chain writes into the other's last segment afterwards; the
+    /// next write to either starts a new segment.
+    ///
+    /// \param that is the ChainedByteBuffer to copy.
+    ChainedByteBuffer(const ChainedByteBuffer& that);
+
+    /// \brief Move a ChainedByteBuffer.
+    /// \param that is the ChainedByteBuffer to move.  It is left empty.
+    ChainedByteBuffer(ChainedByteBuffer&& that);
+
+    /// \brief Copy a ChainedByteBuffer by sharing its segments.
+    /// \param that is the ChainedByteBuffer to copy.
+    /// \returns this ChainedByteBuffer.
+    ChainedByteBuffer& operator = (const ChainedByteBuffer& that);
+
+    /// \brief Move a ChainedByteBuffer.
+    /// \param that is the ChainedByteBuffer to move.  It is left empty.
+    /// \returns this ChainedByteBuffer.
+    ChainedByteBuffer& operator = (ChainedByteBuffer&& that);
+
+    /// \brief Destroy the ChainedByteBuffer.
+    virtual ~ChainedByteBuffer();
+
+    virtual std::size_t readBytes(uint8_t* buffer, std::size_t size) const override;
+    virtual std::size_t readBytes(std::vector<uint8_t>& buffer) const override;
+    virtual std::size_t readBytes(std::string& buffer) const override;
+    virtual std::size_t readBytes(AbstractByteSink& buffer) const override;
+    virtual std::vector<uint8_t> readBytes() const override;
+
+    /// \returns a pointer to the bytes if there is at most one segment,
+    ///          otherwise nullptr.  This never coalesces the segments.
+    virtual const uint8_t* getContiguousPtr() const override;
+
+    virtual bool getChunk(std::size_t index,
+                          const uint8_t*& data,
+                          std::size_t& size) const override;
+
+    virtual std::size_t writeByte(uint8_t data) override;
+    virtual std::size_t writeBytes(const uint8_t* buffer, std::size_t size) override;
+    virtual std::size_t writeBytes(const std::vector<uint8_t>& buffer) override;
+    virtual std::size_t writeBytes(const std::string& buffer) override;
+    virtual std::size_t writeBytes(const AbstractByteSource& buffer) override;
+
+    /// \brief Append a shared buffer without copying it.
+    /// \param buffer is the buffer to append.  It must not be modified while
+    ///        it is part of the chain.
+    void append(SharedByteBuffer buffer);
+
+    /// \brief Append a buffer by taking ownership of its storage.
+    /// \param buffer is the buffer to append.  It is left empty.
+    void append(ByteBuffer&& buffer);
+
+    /// \brief Append the segments of another chain without copying them.
+    /// \param buffer is the chain to append.
+    void append(const ChainedByteBuffer& buffer);
+
+    /// \brief Prepend a shared buffer without copying it.
+    /// \param buffer is the buffer to prepend.  It must not be modified while
+    ///        it is part of the chain.
+    void prepend(SharedByteBuffer buffer);
+
+    /// \brief Prepend a buffer by taking ownership of its storage.
+    /// \param buffer is the buffer to prepend.  It is left empty.
+    void prepend(ByteBuffer&& buffer);
+
+    /// \brief Prepend the segments of another chain without copying them.
+    /// \param buffer is the chain to prepend.
+    void prepend(const ChainedByteBuffer& buffer);
+
+    /// \brief Query the number of bytes in the chain.
+    /// \returns the number of bytes in the chain.
+    std::size_t size() const override;
+
+    /// \brief Query the number of segments in the chain.
+    /// \returns the number of segments in the chain.
+    std::size_t getSegmentCount() const;
+
+    /// \brief Determine if the chain is empty.
+    /// \returns true iff the number of bytes in the chain is 0.
+    bool empty() const;
+
+    /// \brief Remove all segments from the chain.
+    void clear();
+
+    /// \brief Copy all segments into a single contiguous segment.
+    ///
+    /// This is a no-op if the chain has at most one segment.
+    void coalesce();
+
+    /// \brief Get a pointer to the bytes, coalescing the segments if needed.
+    /// \returns a pointer to size() contiguous bytes or nullptr if empty.
+    const uint8_t* getPtr();
+
+    /// \brief Write all segments to a file descriptor.
+    ///
+    /// Segments are written with scatter-gather writes (i.e. writev()),
+    /// so the bytes are never coalesced or copied in user space.
+    ///
+    /// \param fd The file descriptor to write to.
+    /// \returns the number of bytes written.
+    /// \throws Poco::IOException if the write fails.
+    /// \throws Poco::NotImplementedException if the platform does not support
+    ///         scatter-gather writes.
+    std::size_t writeTo(int fd) const;
+
+    enum
+    {
+        /// \brief The default minimum capacity of a written segment.
+        DEFAULT_SEGMENT_SIZE = 4096
+    };
+
+private:
+    /// \brief A range of bytes in a shared buffer.
+    struct Segment
+    {
+        /// \brief The shared buffer backing the segment.
+        SharedByteBuffer buffer;
+
+        /// \brief The index of the segment's first byte in the buffer.
+        std::size_t offset;
+
+        /// \brief The number of bytes in the segment.
+        std::size_t size;
+
+        /// \returns a pointer to the first byte in the segment.
+        const uint8_t* data() const
+        {
+            return buffer->getPtr() + offset;
+        }
+    };
+
+    /// \brief Make a segment spanning an entire buffer.
+    /// \param buffer The buffer to wrap.
+    /// \returns the segment.
+    static Segment _makeSegment(SharedByteBuffer buffer);
+
+    /// \brief The minimum capacity of written segments.
+    std::size_t _segmentSize;
+
+    /// \brief The segments in order.
+    std::deque<Segment> _segments;
+
+    /// \brief The writable buffer backing the last segment, if any.
+    ///
+    /// This is only set while the last segment was allocated by this chain
+    /// and is not shared with a copy of the chain.
+    std::shared_ptr<ByteBuffer> _tail;
+
+    /// \brief The total number of bytes in all segments.
+    std::size_t _size;
+
+};
+
+
+} }  // namespace ofx::IO
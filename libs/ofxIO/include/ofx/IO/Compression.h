@@ -23,8 +23,12 @@
 // =============================================================================
 
 
+#pragma once
+
+
 #include <stdint.h>
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferView.h"
 
 
 namespace ofx {
@@ -32,6 +36,11 @@ namespace IO {
 
 
 /// \brief A class for compressing and uncompressing ByteBuffers.
+///
+/// SNAPPY and LZ4 compress a whole buffer as one raw block with no header.
+/// LZ4_FRAME wraps LZ4 blocks in the standard frame format.  To compress
+/// data incrementally with bounded memory, use Compressor, Decompressor or
+/// the CompressingOutputStream and DecompressingInputStream adapters.
 class Compression
 {
 public:
@@ -44,7 +53,20 @@ public:
         /// \brief Use the snappy compression algorithm.
         SNAPPY,
         /// \brief Use the LZ4 compression algorithm.
-        LZ4
+        LZ4,
+        /// \brief Use the LZ4 frame format, which records the content size
+        ///        and checksums and can be read by the `lz4` tool.
+        LZ4_FRAME
+    };
+
+    enum
+    {
+        /// \brief The largest output tried when uncompressing a raw LZ4
+        ///        block, which does not record its uncompressed size.
+        ///
+        /// Blocks that expand by no more than 4x are always uncompressed.
+        /// Use LZ4_FRAME for larger data.
+        MAX_LZ4_UNCOMPRESSED_SIZE = 64 * 1024 * 1024
     };
 
     /// \brief Uncompress a ByteBuffer.
@@ -56,6 +78,20 @@ public:
                                   ByteBuffer& uncompressedBuffer,
                                   Type type);
 
+    /// \brief Uncompress a ByteBufferView.
+    ///
+    /// A raw LZ4 block is tried with a growing output buffer of up to
+    /// MAX_LZ4_UNCOMPRESSED_SIZE bytes.  On error, uncompressedBuffer is
+    /// left empty.
+    ///
+    /// \param compressedBuffer The view of the bytes compressed with `type` compression.
+    /// \param uncompressedBuffer The buffer to fill with uncompressed bytes.
+    /// \param type The compression Type.
+    /// \returns the number of bytes uncompressed or 0 if error.
+    static std::size_t uncompress(const ByteBufferView& compressedBuffer,
+                                  ByteBuffer& uncompressedBuffer,
+                                  Type type);
+
     /// \brief Uncomress a ByteBuffer using Type::ZLIB.
     /// \param compressedBuffer The compressed buffer.
     /// \param uncompressedBuffer The empty buffer to decompress with `zlib`.
@@ -67,6 +103,17 @@ public:
                                   ByteBuffer& uncompressedBuffer,
                                   int windowBits);
 
+    /// \brief Uncompress a ByteBufferView using Type::ZLIB.
+    /// \param compressedBuffer The view of the compressed bytes.
+    /// \param uncompressedBuffer The empty buffer to decompress with `zlib`.
+    /// \param windowBits See deflateInit2() for more informtion.
+    ///                   Must be in range (8 - 15) inclusive.
+    /// \returns the number of bytes uncompressed or 0 if error.
+    /// \sa http://www.zlib.net/manual.html
+    static std::size_t uncompress(const ByteBufferView& compressedBuffer,
+                                  ByteBuffer& uncompressedBuffer,
+                                  int windowBits);
+
     /// \brief Compress a ByteBuffer.
     /// \param uncompressedBuffer The buffer to compress with `type` compression.
     /// \param compressedBuffer The buffer to fill with compressed bytes.
@@ -76,6 +123,15 @@ public:
                                 ByteBuffer& compressedBuffer,
                                 Type type);
 
+    /// \brief Compress a ByteBufferView.
+    /// \param uncompressedBuffer The view of the bytes to compress with `type` compression.
+    /// \param compressedBuffer The buffer to fill with compressed bytes.
+    /// \param type The compression Type.
+    /// \returns the number of compressed bytes or 0 if error.
+    static std::size_t compress(const ByteBufferView& uncompressedBuffer,
+                                ByteBuffer& compressedBuffer,
+                                Type type);
+
     /// \brief Compress a ByteBuffer.
     /// \param uncompressedBuffer The buffer to compress with `type` compression.
     /// \param compressedBuffer The buffer to fill with compressed bytes.
@@ -89,6 +145,19 @@ public:
                                 Type type,
                                 int level);
 
+    /// \brief Compress a ByteBufferView.
+    /// \param uncompressedBuffer The view of the bytes to compress with `type` compression.
+    /// \param compressedBuffer The buffer to fill with compressed bytes.
+    /// \param type The compression Type.
+    /// \param level The compression level (1 - 8) inclusive.
+    ///        Only valid for Type::ZLIB and Type::GZIP.
+    /// \returns the number of compressed bytes or 0 if error.
+    /// \sa http://www.zlib.net/manual.html
+    static std::size_t compress(const ByteBufferView& uncompressedBuffer,
+                                ByteBuffer& compressedBuffer,
+                                Type type,
+                                int level);
+
     /// \brief Compress a ByteBuffer using Type::ZLIB.
     /// \param uncompressedBuffer The buffer to compress with `zlib` compression.
     /// \param compressedBuffer The buffer to fill with compressed bytes.
@@ -102,6 +171,19 @@ public:
                                 int windowBits,
                                 int level);
 
+    /// \brief Compress a ByteBufferView using Type::ZLIB.
+    /// \param uncompressedBuffer The view of the bytes to compress with `zlib` compression.
+    /// \param compressedBuffer The buffer to fill with compressed bytes.
+    /// \param windowBits See deflateInit2() for more informtion.
+    ///                   Must be in range (8 - 15) inclusive.
+    /// \param level The compression level (1 - 8) inclusive.
+    /// \returns the number of compressed bytes or 0 if error.
+    /// \sa http://www.zlib.net/manual.html
+    static std::size_t compress(const ByteBufferView& uncompressedBuffer,
+                                ByteBuffer& compressedBuffer,
+                                int windowBits,
+                                int level);
+
     /// \brief Query the string representation of the compression lib version.
     /// \param type The compression type.
     /// \returns the string representation of the compression lib version.
@@ -0,0 +1,458 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include "Poco/StreamUtil.h"
+#include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferView.h"
+#include "ofx/IO/Compression.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Options for writing the LZ4 frame format.
+struct LZ4FrameOptions
+{
+    /// \brief The maximum uncompressed size of a block.
+    enum BlockSize
+    {
+        BLOCK_SIZE_64KB = 4,
+        BLOCK_SIZE_256KB = 5,
+        BLOCK_SIZE_1MB = 6,
+        BLOCK_SIZE_4MB = 7
+    };
+
+    /// \brief Create the default options: 4 MiB independent blocks with a
+    ///        content checksum, and no content size.
+    LZ4FrameOptions();
+
+    /// \brief The maximum uncompressed size of a block.
+    BlockSize blockSize;
+
+    /// \brief True if each block may refer to the previous 64 KiB of data.
+    ///
+    /// Linked blocks compress better, but cannot be decompressed on their
+    /// own.
+    bool linkedBlocks;
+
+    /// \brief True to add an xxHash32 checksum to each block.
+    bool blockChecksums;
+
+    /// \brief True to add an xxHash32 checksum of all data to the end of
+    ///        the frame.
+    bool contentChecksum;
+
+    /// \brief True to record contentSize in the frame header.
+    bool hasContentSize;
+
+    /// \brief The total uncompressed size, if hasContentSize is true.
+    uint64_t contentSize;
+
+    /// \returns the maximum uncompressed size of a block in bytes.
+    std::size_t blockSizeBytes() const;
+};
+
+
+/// \brief Compresses a stream of bytes incrementally.
+///
+/// Input is collected into independently compressed blocks, so memory use is
+/// bounded by the block size no matter how much data is compressed.  The
+/// output is a standard streaming container rather than the raw block that
+/// Compression::compress() produces:
+///
+///   - Compression::SNAPPY uses the Snappy framing format, with 64 KiB chunks
+///     and masked CRC-32C checksums.
+///   - Compression::LZ4 uses the LZ4 legacy frame format, with 8 MiB blocks,
+///     which `lz4 -d` can read.
+///   - Compression::LZ4_FRAME uses the LZ4 frame format, configured with
+///     LZ4FrameOptions.
+///
+/// ZLIB and GZIP streams are supported by Poco::DeflatingOutputStream.
+///
+///     Compressor compressor(Compression::LZ4);
+///     ByteBuffer compressed;
+///
+///     while (reader.next(chunk))
+///     {
+///         compressor.update(chunk, compressed);
+///         // write and clear compressed ...
+///     }
+///
+///     compressor.finish(compressed);
+///
+class Compressor
+{
+public:
+    /// \brief Create a Compressor.
+    /// \param type The compression type.
+    /// \throws Poco::InvalidArgumentException if the type cannot be streamed.
+    explicit Compressor(Compression::Type type);
+
+    /// \brief Create a Compressor for the LZ4 frame format.
+    /// \param options The frame options.
+    explicit Compressor(const LZ4FrameOptions& options);
+
+    /// \brief Destroy the Compressor.
+    ~Compressor();
+
+    /// \brief Compress more input.
+    ///
+    /// Complete blocks are compressed and appended to output.  The rest of
+    /// the input is kept until the block is filled or the stream is flushed.
+    ///
+    /// \param input The bytes to compress.
+    /// \param output The buffer to append compressed bytes to.
+    /// \returns the number of bytes appended to output.
+    std::size_t update(const ByteBufferView& input, ByteBuffer& output);
+
+    /// \brief Compress any pending input as a short block.
+    ///
+    /// Everything passed to update() can be decompressed from the output so
+    /// far, at some cost in compression ratio.
+    ///
+    /// \param output The buffer to append compressed bytes to.
+    /// \returns the number of bytes appended to output.
+    std::size_t flush(ByteBuffer& output);
+
+    /// \brief Compress any pending input and end the stream.
+    ///
+    /// The Compressor can then be reused for a new stream.
+    ///
+    /// \param output The buffer to append compressed bytes to.
+    /// \returns the number of bytes appended to output.
+    /// \throws Poco::IllegalStateException if an LZ4 frame content size was
+    ///         given and a different number of bytes was compressed.
+    std::size_t finish(ByteBuffer& output);
+
+    /// \returns the compression type.
+    Compression::Type type() const;
+
+    /// \returns the maximum number of uncompressed bytes in a block.
+    std::size_t blockSize() const;
+
+    enum
+    {
+        /// \brief The maximum uncompressed size of a Snappy framed chunk.
+        SNAPPY_BLOCK_SIZE = 64 * 1024,
+
+        /// \brief The uncompressed size of an LZ4 legacy frame block.
+        LZ4_LEGACY_BLOCK_SIZE = 8 * 1024 * 1024
+    };
+
+private:
+    Compressor(const Compressor&);
+    Compressor& operator = (const Compressor&);
+
+    /// \brief Write the stream header if it has not been written.
+    /// \param output The buffer to append the header to.
+    void _writeHeader(ByteBuffer& output);
+
+    /// \brief Compress a block and append it to output.
+    /// \param data The bytes to compress.
+    /// \param size The number of bytes, at most blockSize().
+    /// \param output The buffer to append the block to.
+    void _compressBlock(const uint8_t* data,
+                        std::size_t size,
+                        ByteBuffer& output);
+
+    /// \brief The compression type.
+    Compression::Type _type;
+
+    /// \brief The maximum uncompressed size of a block.
+    std::size_t _blockSize;
+
+    /// \brief True once the stream header has been written.
+    bool _headerWritten;
+
+    /// \brief Input waiting for a complete block.
+    ByteBuffer _pending;
+
+    /// \brief The LZ4 frame encoder state.
+    struct LZ4FrameEncoder;
+
+    /// \brief The LZ4 frame encoder state, for Compression::LZ4_FRAME.
+    std::unique_ptr<LZ4FrameEncoder> _frame;
+
+};
+
+
+/// \brief Decompresses a stream of bytes incrementally.
+///
+/// Reads the containers written by Compressor.  Input may be split at any
+/// byte; incomplete blocks are kept until the rest of the block arrives.
+///
+/// Compression::LZ4_FRAME accepts any frame written by the `lz4` tool,
+/// including concatenated and skippable frames, but not frames that need an
+/// external dictionary.  All checksums present in the frame are verified.
+class Decompressor
+{
+public:
+    /// \brief Create a Decompressor.
+    /// \param type The compression type.
+    /// \throws Poco::InvalidArgumentException if the type cannot be streamed.
+    explicit Decompressor(Compression::Type type);
+
+    /// \brief Destroy the Decompressor.
+    ~Decompressor();
+
+    /// \brief Decompress more input.
+    /// \param input The compressed bytes.
+    /// \param output The buffer to append decompressed bytes to.
+    /// \returns the number of bytes appended to output.
+    /// \throws Poco::DataFormatException if the input is corrupt or a
+    ///         checksum does not match.
+    std::size_t update(const ByteBufferView& input, ByteBuffer& output);
+
+    /// \brief Check that the stream ended on a block boundary.
+    ///
+    /// The Decompressor can then be reused for a new stream.
+    ///
+    /// \throws Poco::DataFormatException if the stream is truncated.
+    void finish();
+
+    /// \returns the compression type.
+    Compression::Type type() const;
+
+    /// \brief Read the content size from an LZ4 frame header.
+    /// \param buffer The bytes starting with the frame header.
+    /// \param contentSize Set to the content size, if it is recorded.
+    /// \returns true iff the buffer starts with an LZ4 frame header that
+    ///          records the content size.
+    static bool getLZ4FrameContentSize(const ByteBufferView& buffer,
+                                       uint64_t& contentSize);
+
+private:
+    Decompressor(const Decompressor&);
+    Decompressor& operator = (const Decompressor&);
+
+    /// \brief Decompress all complete blocks.
+    /// \param data The compressed bytes.
+    /// \param size The number of compressed bytes.
+    /// \param output The buffer to append decompressed bytes to.
+    /// \returns the number of compressed bytes consumed.
+    std::size_t _decompressBlocks(const uint8_t* data,
+                                  std::size_t size,
+                                  ByteBuffer& output);
+
+    /// \brief Decompress all complete blocks of LZ4 frames.
+    /// \param data The compressed bytes.
+    /// \param size The number of compressed bytes.
+    /// \param output The buffer to append decompressed bytes to.
+    /// \returns the number of compressed bytes consumed.
+    std::size_t _decompressLZ4Frames(const uint8_t* data,
+                                     std::size_t size,
+                                     ByteBuffer& output);
+
+    /// \brief The compression type.
+    Compression::Type _type;
+
+    /// \brief True once the stream header has been read.
+    bool _headerRead;
+
+    /// \brief Input waiting for a complete block.
+    ByteBuffer _pending;
+
+    /// \brief The LZ4 frame decoder state.
+    struct LZ4FrameDecoder;
+
+    /// \brief The LZ4 frame decoder state, for Compression::LZ4_FRAME.
+    std::unique_ptr<LZ4FrameDecoder> _frame;
+
+};
+
+
+/// \brief A stream buffer that compresses everything written to it.
+///
+/// A full block is collected in the put area and compressed directly from
+/// there.  Flushing the stream writes a short block.
+class CompressingStreamBuf: public std::streambuf
+{
+public:
+    /// \brief Create a CompressingStreamBuf.
+    /// \param ostr The stream to write compressed bytes to.
+    /// \param type The compression type.
+    CompressingStreamBuf(std::ostream& ostr, Compression::Type type);
+
+    /// \brief Destroy the CompressingStreamBuf, closing it if needed.
+    virtual ~CompressingStreamBuf();
+
+    /// \brief Compress any remaining bytes and end the compressed stream.
+    ///
+    /// Further writes fail.
+    void close();
+
+protected:
+    int_type overflow(int_type c) override;
+
+    std::streamsize xsputn(const char_type* buffer, std::streamsize size) override;
+
+    int sync() override;
+
+private:
+    CompressingStreamBuf(const CompressingStreamBuf&);
+    CompressingStreamBuf& operator = (const CompressingStreamBuf&);
+
+    /// \brief Compress the put area and empty it.
+    void _compressPutArea();
+
+    /// \brief Write the compressed bytes to the stream.
+    void _writeOutput();
+
+    /// \brief The stream to write compressed bytes to.
+    std::ostream* _ostr;
+
+    /// \brief The compressor.
+    Compressor _compressor;
+
+    /// \brief The put area, one block long.
+    ByteBuffer _block;
+
+    /// \brief Compressed bytes waiting to be written.
+    ByteBuffer _output;
+
+};
+
+
+/// \brief A stream buffer that decompresses a compressed stream.
+///
+/// Errors in the compressed data are thrown as Poco::DataFormatException,
+/// which the stream reports by setting badbit.
+class DecompressingStreamBuf: public std::streambuf
+{
+public:
+    /// \brief Create a DecompressingStreamBuf.
+    /// \param istr The stream to read compressed bytes from.
+    /// \param type The compression type.
+    DecompressingStreamBuf(std::istream& istr, Compression::Type type);
+
+    /// \brief Destroy the DecompressingStreamBuf.
+    virtual ~DecompressingStreamBuf();
+
+    enum
+    {
+        /// \brief The number of compressed bytes read at a time.
+        DEFAULT_BUFFER_SIZE = 64 * 1024
+    };
+
+protected:
+    int_type underflow() override;
+
+private:
+    DecompressingStreamBuf(const DecompressingStreamBuf&);
+    DecompressingStreamBuf& operator = (const DecompressingStreamBuf&);
+
+    /// \brief The stream to read compressed bytes from.
+    std::istream* _istr;
+
+    /// \brief The decompressor.
+    Decompressor _decompressor;
+
+    /// \brief True once the compressed stream has ended.
+    bool _eof;
+
+    /// \brief Compressed bytes read from the stream.
+    ByteBuffer _input;
+
+    /// \brief Decompressed bytes, exposed as the get area.
+    ByteBuffer _output;
+
+};
+
+
+class CompressingIOS: public virtual std::ios
+{
+public:
+    CompressingIOS(std::ostream& ostr, Compression::Type type):
+        _buf(ostr, type)
+    {
+        poco_ios_init(&_buf);
+    }
+
+protected:
+    CompressingStreamBuf _buf;
+
+};
+
+
+/// \brief An output stream that compresses everything written to it.
+///
+///     std::ofstream file("log.lz4", std::ios::binary);
+///     CompressingOutputStream compressor(file, Compression::LZ4);
+///     compressor << "...";
+///     compressor.close();
+///
+class CompressingOutputStream: public CompressingIOS, public std::ostream
+{
+public:
+    CompressingOutputStream(std::ostream& ostr, Compression::Type type):
+        CompressingIOS(ostr, type),
+        std::ostream(&_buf)
+    {
+    }
+
+    /// \brief Compress any remaining bytes and end the compressed stream.
+    void close()
+    {
+        _buf.close();
+    }
+};
+
+
+class DecompressingIOS: public virtual std::ios
+{
+public:
+    DecompressingIOS(std::istream& istr, Compression::Type type):
+        _buf(istr, type)
+    {
+        poco_ios_init(&_buf);
+    }
+
+protected:
+    DecompressingStreamBuf _buf;
+
+};
+
+
+/// \brief An input stream that decompresses a compressed stream.
+class DecompressingInputStream: public DecompressingIOS, public std::istream
+{
+public:
+    DecompressingInputStream(std::istream& istr, Compression::Type type):
+        DecompressingIOS(istr, type),
+        std::istream(&_buf)
+    {
+    }
+};
+
+
+} } // namespace ofx::IO
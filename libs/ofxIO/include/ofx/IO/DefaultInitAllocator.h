@@ -0,0 +1,89 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <memory>
+#include <new>
+#include <utility>
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief An allocator adaptor that default-initializes elements.
+///
+/// Standard containers value-initialize elements when they are resized, which
+/// for bytes means zero-filling memory that is often overwritten immediately.
+/// With this allocator, `resize(n)` leaves new trivial elements uninitialized,
+/// while `resize(n, value)` and all other constructors behave as usual.
+///
+/// \tparam Type The element type.
+/// \tparam BaseAllocator The allocator used for allocation.
+template <typename Type, typename BaseAllocator = std::allocator<Type>>
+class DefaultInitAllocator: public BaseAllocator
+{
+public:
+    typedef std::allocator_traits<BaseAllocator> BaseTraits;
+
+    template <typename OtherType>
+    struct rebind
+    {
+        typedef DefaultInitAllocator<OtherType,
+                                     typename BaseTraits::template rebind_alloc<OtherType>> other;
+    };
+
+    DefaultInitAllocator()
+    {
+    }
+
+    template <typename OtherType, typename OtherBaseAllocator>
+    DefaultInitAllocator(const DefaultInitAllocator<OtherType, OtherBaseAllocator>& other):
+        BaseAllocator(other)
+    {
+    }
+
+    /// \brief Default-initialize an element.
+    template <typename OtherType>
+    void construct(OtherType* ptr)
+    {
+        ::new (static_cast<void*>(ptr)) OtherType;
+    }
+
+    /// \brief Construct an element using the base allocator.
+    template <typename OtherType, typename... Args>
+    void construct(OtherType* ptr, Args&&... args)
+    {
+        BaseTraits::construct(static_cast<BaseAllocator&>(*this),
+                              ptr,
+                              std::forward<Args>(args)...);
+    }
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,162 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ofx/IO/ByteBuffer.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Reads a file as a sequence of fixed-size chunks.
+///
+/// The next chunk is read on a background thread while the caller processes
+/// the current one, so work such as checksums or decompression overlaps the
+/// disk reads.  Only two chunk buffers exist at a time: the buffer passed to
+/// next() is handed back to the reader and refilled with a later chunk, so
+/// files larger than memory can be processed without allocating per chunk.
+///
+///     FileChunkReader reader("data/huge.bin");
+///     ByteBuffer chunk;
+///
+///     while (reader.next(chunk))
+///     {
+///         crc.update(chunk.getCharPtr(), chunk.size());
+///     }
+///
+class FileChunkReader
+{
+public:
+    /// \brief Open a file and start reading its first chunk.
+    /// \param path The path of the file to read.
+    /// \param chunkSize The size of each chunk.  Only the last chunk may be
+    ///        smaller.
+    /// \throws Poco::FileNotFoundException (or a similar exception) if the
+    ///         file cannot be opened.
+    FileChunkReader(const std::string& path,
+                    std::size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    /// \brief Stop reading and close the file.
+    ~FileChunkReader();
+
+    /// \brief Get the next chunk of the file.
+    ///
+    /// Blocks until the chunk has been read.  The previous contents of
+    /// chunk are discarded and its storage is reused for a later chunk.
+    ///
+    /// \param chunk The buffer to receive the chunk.
+    /// \returns false, with chunk cleared, once the end of the file has been
+    ///          reached.
+    /// \throws Poco::ReadFileException if the background read failed.
+    bool next(ByteBuffer& chunk);
+
+    /// \returns the offset in the file of the chunk returned by the last
+    ///          call to next().
+    std::size_t getChunkOffset() const;
+
+    /// \returns the number of bytes returned by next() so far.
+    std::size_t getBytesRead() const;
+
+    /// \returns the size of each chunk.
+    std::size_t getChunkSize() const;
+
+    /// \returns the path of the file.
+    const std::string& getPath() const;
+
+    enum
+    {
+        /// \brief The default size of each chunk.
+        DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024
+    };
+
+private:
+    FileChunkReader(const FileChunkReader&);
+    FileChunkReader& operator = (const FileChunkReader&);
+
+    /// \brief Fill a buffer with the next chunk of the file.
+    /// \param buffer The buffer to fill.
+    /// \returns the number of bytes read, or 0 at the end of the file.
+    std::size_t _readChunk(ByteBuffer& buffer);
+
+    /// \brief The background read loop.
+    void _run();
+
+    /// \brief The path of the file.
+    std::string _path;
+
+    /// \brief The size of each chunk.
+    std::size_t _chunkSize;
+
+    /// \brief The offset of the chunk returned by the last call to next().
+    std::size_t _chunkOffset;
+
+    /// \brief The number of bytes returned by next().
+    std::size_t _bytesRead;
+
+    /// \brief The open file descriptor on POSIX platforms.
+    int _fd;
+
+    /// \brief The open file stream on other platforms.
+    std::unique_ptr<std::istream> _stream;
+
+    /// \brief The chunk read ahead, or a spare buffer to read it into.
+    ByteBuffer _pending;
+
+    /// \brief True when _pending holds the next chunk.
+    bool _ready;
+
+    /// \brief True when the end of the file or an error was reached.
+    bool _done;
+
+    /// \brief True when the background thread should exit.
+    bool _stopping;
+
+    /// \brief The exception thrown by the background read, if any.
+    std::exception_ptr _exception;
+
+    /// \brief Guards the state shared with the background thread.
+    std::mutex _mutex;
+
+    /// \brief Signaled when the shared state changes.
+    std::condition_variable _condition;
+
+    /// \brief The background thread.
+    std::thread _thread;
+
+};
+
+
+} }  // namespace ofx::IO
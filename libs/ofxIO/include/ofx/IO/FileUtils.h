@@ -0,0 +1,144 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ofx/IO/DirectoryUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+class AbstractPathFilter;
+
+
+/// \brief A collection of utilities for working with files.
+class FileUtils
+{
+public:
+    /// \brief Options for copying files.
+    enum CopyOptions
+    {
+        /// \brief Fail if a target file already exists.
+        COPY_DEFAULT = 0,
+        /// \brief Replace target files that already exist.
+        COPY_OVERWRITE = 1 << 0,
+        /// \brief Always copy the data rather than sharing the source's
+        ///        blocks with a reflink (copy-on-write clone).
+        COPY_NO_REFLINK = 1 << 1
+    };
+
+    /// \brief Copy a file without passing its bytes through user space.
+    ///
+    /// The fastest available method is used, in order:
+    ///
+    ///   - a reflink (FICLONE on Linux, clonefile on macOS), which shares the
+    ///     source's blocks until either file is modified,
+    ///   - copy_file_range() or sendfile() on Linux, and fcopyfile() on
+    ///     macOS, which copy inside the kernel,
+    ///   - read() / write() with a large block size.
+    ///
+    /// The target is created with the source's permissions.  If the copy
+    /// fails, a partially written target is removed.
+    ///
+    /// \param sourcePath The path of the file to copy.
+    /// \param targetPath The path of the copy.
+    /// \param options A combination of CopyOptions.
+    /// \returns The number of bytes copied.
+    /// \throws Poco::FileNotFoundException (or a similar exception) if the
+    ///         source cannot be opened, Poco::FileExistsException if the
+    ///         target exists and COPY_OVERWRITE is not set,
+    ///         Poco::CreateFileException if the target cannot be created, and
+    ///         Poco::ReadFileException or Poco::WriteFileException if the copy
+    ///         fails.
+    static std::size_t copy(const std::string& sourcePath,
+                            const std::string& targetPath,
+                            int options = COPY_OVERWRITE);
+
+    /// \brief Copy a batch of paths from one directory tree to another.
+    ///
+    /// Each path must be inside sourceDirectory, as returned by
+    /// DirectoryUtils::listRecursive().  Its relative path is recreated in
+    /// targetDirectory.  Directories are created and files are copied with
+    /// copy().  Missing parent directories are created as needed.
+    ///
+    /// \param paths The absolute paths of the files and directories to copy.
+    /// \param sourceDirectory The absolute path of the source root.
+    /// \param targetDirectory The absolute path of the target root.
+    /// \param options A combination of CopyOptions.
+    /// \returns The total number of bytes copied.
+    /// \throws Poco::InvalidArgumentException if a path is not inside
+    ///         sourceDirectory, or any exception thrown by copy().  Files
+    ///         copied before the error are left in place.
+    static std::size_t copy(const std::vector<std::string>& paths,
+                            const std::string& sourceDirectory,
+                            const std::string& targetDirectory,
+                            int options = COPY_OVERWRITE);
+
+    /// \brief Recursively copy the contents of a directory.
+    ///
+    /// The directory is listed with DirectoryUtils::listRecursive() and the
+    /// results are copied with copy().
+    ///
+    /// \param sourceDirectory The path of the directory to copy.
+    /// \param targetDirectory The path of the copy.
+    /// \param options A combination of CopyOptions.
+    /// \param pFilter will allow only certain paths to be copied.
+    /// \param maxDepth determines the depth of the recursion.
+    /// \returns The total number of bytes copied.
+    static std::size_t copyRecursive(const std::string& sourceDirectory,
+                                     const std::string& targetDirectory,
+                                     int options = COPY_OVERWRITE,
+                                     AbstractPathFilter* pFilter = 0,
+                                     Poco::UInt16 maxDepth = DirectoryUtils::INIFINITE_DEPTH);
+
+    enum
+    {
+        /// \brief The block size used when the kernel cannot copy directly.
+        COPY_BUFFER_SIZE = 1024 * 1024
+    };
+
+private:
+    /// \brief Copy the remaining bytes between file descriptors.
+    /// \param sourceFd The source file descriptor.
+    /// \param targetFd The target file descriptor.
+    /// \param size The size of the source, or 0 if unknown.
+    /// \param options A combination of CopyOptions.
+    /// \returns The number of bytes copied.
+    /// \throws Poco::ReadFileException or Poco::WriteFileException on error.
+    static std::size_t _copyFileDescriptor(int sourceFd,
+                                           int targetFd,
+                                           std::size_t size,
+                                           int options);
+
+};
+
+
+} } // namespace ofx::IO
@@ -23,6 +23,9 @@
 // =============================================================================
 
 
+#pragma once
+
+
 #include "ofx/IO/AbstractTypes.h"
 
 
@@ -46,6 +49,12 @@ public:
 
     std::size_t decode(const ByteBuffer& buffer,
                        ByteBuffer& decodedBuffer) override;
+
+    std::size_t encode(const ByteBufferView& buffer,
+                       ByteBuffer& encodedBuffer) override;
+
+    std::size_t decode(const ByteBufferView& buffer,
+                       ByteBuffer& decodedBuffer) override;
     
 };
 
@@ -0,0 +1,162 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include "ofx/IO/AbstractTypes.h"
+#include "ofx/IO/ByteBufferView.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A read-only byte source backed by a memory-mapped file.
+///
+/// The file's pages are mapped into memory and loaded by the operating system
+/// as they are touched, so a large file can be processed without reading it
+/// into a ByteBuffer first.  A MappedByteBuffer converts implicitly to a
+/// ByteBufferView and can be passed directly to Compression, the encoders and
+/// ByteBufferReader.
+///
+/// \warning Views of the mapping must not outlive the MappedByteBuffer.  If
+///          the file is truncated by another process while it is mapped,
+///          accessing the missing pages raises SIGBUS.
+class MappedByteBuffer: public AbstractByteSource
+{
+public:
+    /// \brief Hints about how the mapped bytes will be accessed.
+    enum AccessPattern
+    {
+        /// \brief No special treatment.
+        ACCESS_NORMAL,
+        /// \brief Pages will be read in order; read ahead aggressively.
+        ACCESS_SEQUENTIAL,
+        /// \brief Pages will be read in random order; do not read ahead.
+        ACCESS_RANDOM,
+        /// \brief Pages will be needed soon; start loading them now.
+        ACCESS_WILL_NEED
+    };
+
+    /// \brief Construct an empty MappedByteBuffer.
+    MappedByteBuffer();
+
+    /// \brief Map an entire file.
+    /// \param path The path of the file to map.
+    /// \param pattern The expected access pattern.
+    /// \throws Poco::FileNotFoundException if the file does not exist.
+    /// \throws Poco::FileException if the file cannot be opened or mapped.
+    /// \throws Poco::NotImplementedException if mapping is not supported on
+    ///         this platform.
+    explicit MappedByteBuffer(const std::string& path,
+                              AccessPattern pattern = ACCESS_NORMAL);
+
+    /// \brief Move a mapping.
+    /// \param that The MappedByteBuffer to move.  It is left empty.
+    MappedByteBuffer(MappedByteBuffer&& that) noexcept;
+
+    /// \brief Move a mapping.
+    /// \param that The MappedByteBuffer to move.  It is left empty.
+    /// \returns this MappedByteBuffer.
+    MappedByteBuffer& operator = (MappedByteBuffer&& that) noexcept;
+
+    /// \brief Unmap the file.
+    virtual ~MappedByteBuffer();
+
+    virtual std::size_t readBytes(uint8_t* buffer, std::size_t size) const override;
+    virtual std::size_t readBytes(std::vector<uint8_t>& buffer) const override;
+    virtual std::size_t readBytes(std::string& buffer) const override;
+    virtual std::size_t readBytes(AbstractByteSink& buffer) const override;
+    virtual std::vector<uint8_t> readBytes() const override;
+    virtual const uint8_t* getContiguousPtr() const override;
+
+    /// \brief Query the number of mapped bytes.
+    /// \returns the size of the mapped file.
+    std::size_t size() const override;
+
+    /// \brief Determine if the mapping is empty.
+    /// \returns true iff no bytes are mapped.
+    bool empty() const;
+
+    /// \brief Unmap the file and leave this MappedByteBuffer empty.
+    void close();
+
+    /// \brief Advise the operating system of an access pattern.
+    ///
+    /// Advice is only a hint and is silently ignored if unsupported.
+    ///
+    /// \param pattern The expected access pattern.
+    /// \param offset The index of the first byte the advice applies to.
+    /// \param size The number of bytes the advice applies to.  The range is
+    ///        clamped to the mapping.
+    void advise(AccessPattern pattern,
+                std::size_t offset = 0,
+                std::size_t size = std::string::npos) const;
+
+    /// \param n is the element index in the mapping.
+    ///
+    /// The value of n should not exceed size() - 1.
+    ///
+    /// \returns a copy of the byte at position n in the mapping.
+    uint8_t operator [] (std::size_t n) const;
+
+    /// \brief Get a const pointer to the mapped bytes.
+    /// \returns a const pointer to the mapped bytes or nullptr if empty.
+    const uint8_t* getPtr() const;
+
+    /// \brief Get a const char pointer to the mapped bytes.
+    /// \returns a const char pointer to the mapped bytes or nullptr if empty.
+    const char* getCharPtr() const;
+
+    /// \brief Get a view of a range of the mapping.
+    ///
+    /// The range is clamped to the bounds of the mapping.
+    ///
+    /// \param offset is the index of the first byte in the view.
+    /// \param size is the maximum number of bytes in the view.
+    /// \returns a view of the requested range.
+    ByteBufferView view(std::size_t offset = 0,
+                        std::size_t size = std::string::npos) const;
+
+    /// \brief View the entire mapping.
+    operator ByteBufferView() const;
+
+private:
+    MappedByteBuffer(const MappedByteBuffer&);
+    MappedByteBuffer& operator = (const MappedByteBuffer&);
+
+    /// \brief A pointer to the first mapped byte.
+    uint8_t* _data;
+
+    /// \brief The number of mapped bytes.
+    std::size_t _size;
+
+};
+
+
+} }  // namespace ofx::IO
@@ -24,9 +24,13 @@
 // =============================================================================
 
 
+#pragma once
+
+
 #include <stdint.h>
 #include "ofx/IO/AbstractTypes.h"
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferView.h"
 
 
 namespace ofx {
@@ -58,6 +62,24 @@ public:
     std::size_t decode(const ByteBuffer& buffer,
                 ByteBuffer& decodedBuffer) override;
 
+    std::size_t encode(const ByteBufferView& buffer,
+                       ByteBuffer& encodedBuffer) override;
+
+    std::size_t decode(const ByteBufferView& buffer,
+                       ByteBuffer& decodedBuffer) override;
+
+    /// \brief Decode a buffer in place and move it into decodedBuffer.
+    ///
+    /// The decoded bytes are never larger than the encoded bytes, so no
+    /// bytes are copied into a separate buffer.
+    ///
+    /// \param buffer The buffer to decode.  Its contents are unspecified
+    ///        afterwards.
+    /// \param decodedBuffer The target buffer.
+    /// \returns The number of bytes in the decoded buffer.
+    std::size_t decode(ByteBuffer&& buffer,
+                       ByteBuffer& decodedBuffer) override;
+
     /// \brief Encode a byte buffer with the SLIP encoder.
     /// \param buffer The buffer to encode.
     /// \param size The size of the buffer to encode.
@@ -74,6 +96,7 @@ public:
     /// \param size The size of the SLIP-encoded buffer.
     /// \param decodedBuffer The target buffer for the decoded bytes.
     /// \returns The number of bytes in the decoded buffer.
+    /// \note decodedBuffer may be the same as buffer to decode in place.
     /// \warning decodedBuffer must have a minimum capacity of (size - 1).
     static std::size_t decode(const uint8_t* buffer,
                               std::size_t size,
@@ -0,0 +1,269 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include "ofx/IO/ByteBufferReader.h"
+#include "ofx/IO/ByteBufferView.h"
+#include "ofx/IO/ByteBufferWriter.h"
+#include "ofx/IO/ByteOrder.h"
+
+
+/// \brief Declare a StructSchema field for a data member.
+///
+/// For example:
+///
+///     struct Header
+///     {
+///         uint16_t type;
+///         uint32_t length;
+///         float values[4];
+///     };
+///
+///     typedef ofx::IO::StructSchema<ofx::IO::ByteOrder::ENDIAN_BIG,
+///                                   OFX_IO_SCHEMA_FIELD(Header, type),
+///                                   OFX_IO_SCHEMA_FIELD(Header, length),
+///                                   OFX_IO_SCHEMA_FIELD(Header, values)> HeaderSchema;
+///
+/// \param Struct The struct type.
+/// \param member The name of the data member.
+#define OFX_IO_SCHEMA_FIELD(Struct, member) \
+    ::ofx::IO::SchemaField<Struct, decltype(Struct::member), &Struct::member>
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Describes one data member of a struct for a StructSchema.
+///
+/// Use OFX_IO_SCHEMA_FIELD() rather than naming this type directly.
+///
+/// \tparam Struct The struct type.
+/// \tparam Type The member type, an arithmetic or enum type of 1, 2, 4 or 8
+///         bytes, or a fixed-size array of them.
+/// \tparam Member A pointer to the data member.
+template <typename Struct, typename Type, Type Struct::*Member>
+class SchemaField
+{
+public:
+    typedef Struct StructType;
+    typedef typename std::remove_all_extents<Type>::type ElementType;
+
+    static_assert(std::is_arithmetic<ElementType>::value ||
+                  std::is_enum<ElementType>::value,
+                  "Field elements must be arithmetic or enum types.");
+    static_assert(sizeof(ElementType) == 1 || sizeof(ElementType) == 2 ||
+                  sizeof(ElementType) == 4 || sizeof(ElementType) == 8,
+                  "Field elements must be 1, 2, 4 or 8 bytes.");
+
+    enum
+    {
+        /// \brief The number of encoded bytes.
+        SIZE = sizeof(Type),
+        /// \brief The number of encoded elements.
+        COUNT = sizeof(Type) / sizeof(ElementType)
+    };
+
+    /// \brief Encode the field.
+    /// \param value The struct to read the field from.
+    /// \param buffer The location of the encoded field.
+    /// \param flip true if the bytes of each element should be reversed.
+    static void encode(const Struct& value, uint8_t* buffer, bool flip)
+    {
+        const ElementType* elements = reinterpret_cast<const ElementType*>(&(value.*Member));
+
+        for (std::size_t i = 0; i < COUNT; ++i)
+        {
+            ElementType element = flip ? ByteOrder::flipBytes(elements[i]) : elements[i];
+            std::memcpy(buffer + i * sizeof(ElementType), &element, sizeof(ElementType));
+        }
+    }
+
+    /// \brief Decode the field.
+    /// \param buffer The location of the encoded field.
+    /// \param value The struct to write the field to.
+    /// \param flip true if the bytes of each element should be reversed.
+    static void decode(const uint8_t* buffer, Struct& value, bool flip)
+    {
+        ElementType* elements = reinterpret_cast<ElementType*>(&(value.*Member));
+
+        for (std::size_t i = 0; i < COUNT; ++i)
+        {
+            ElementType element;
+            std::memcpy(&element, buffer + i * sizeof(ElementType), sizeof(ElementType));
+            elements[i] = flip ? ByteOrder::flipBytes(element) : element;
+        }
+    }
+
+};
+
+
+/// \brief The fixed-offset encoder behind a StructSchema.
+///
+/// Each field is encoded at an offset known at compile time, so encoding a
+/// struct unrolls into straight-line loads, byte swaps and stores.
+template <std::size_t Offset, typename... Fields>
+class SchemaCodec;
+
+
+template <std::size_t Offset>
+class SchemaCodec<Offset>
+{
+public:
+    enum
+    {
+        SIZE = 0
+    };
+
+    template <typename Struct>
+    static void encode(const Struct&, uint8_t*, bool)
+    {
+    }
+
+    template <typename Struct>
+    static void decode(const uint8_t*, Struct&, bool)
+    {
+    }
+
+};
+
+
+template <std::size_t Offset, typename Field, typename... Fields>
+class SchemaCodec<Offset, Field, Fields...>
+{
+public:
+    typedef SchemaCodec<Offset + Field::SIZE, Fields...> Next;
+
+    enum
+    {
+        SIZE = Field::SIZE + Next::SIZE
+    };
+
+    template <typename Struct>
+    static void encode(const Struct& value, uint8_t* buffer, bool flip)
+    {
+        Field::encode(value, buffer + Offset, flip);
+        Next::encode(value, buffer, flip);
+    }
+
+    template <typename Struct>
+    static void decode(const uint8_t* buffer, Struct& value, bool flip)
+    {
+        Field::decode(buffer + Offset, value, flip);
+        Next::decode(buffer, value, flip);
+    }
+
+};
+
+
+/// \brief A compile-time description of a struct's encoded layout.
+///
+/// The fields are encoded in the order they are listed, packed with no
+/// padding, each in the given byte order.  The encoded size is the
+/// compile-time constant SIZE, so reading or writing a struct takes a single
+/// bounds check.
+///
+/// \tparam Order The byte order of the encoded fields.
+/// \tparam Field The first field, declared with OFX_IO_SCHEMA_FIELD().
+/// \tparam Fields The remaining fields of the same struct.
+template <ByteOrder::Endianness Order, typename Field, typename... Fields>
+class StructSchema
+{
+public:
+    /// \brief The struct type described by this schema.
+    typedef typename Field::StructType StructType;
+
+    typedef SchemaCodec<0, Field, Fields...> Codec;
+
+    enum
+    {
+        /// \brief The number of bytes in an encoded struct.
+        SIZE = Codec::SIZE
+    };
+
+    /// \brief Encode a struct.
+    /// \param value The struct to encode.
+    /// \param buffer The target for the encoded bytes.
+    /// \warning buffer must have a minimum capacity of SIZE.
+    static void encode(const StructType& value, uint8_t* buffer)
+    {
+        Codec::encode(value, buffer, ByteOrder::needsFlip(Order));
+    }
+
+    /// \brief Decode a struct.
+    /// \param buffer The encoded bytes.
+    /// \param value The struct to fill.
+    /// \warning buffer must hold at least SIZE bytes.
+    static void decode(const uint8_t* buffer, StructType& value)
+    {
+        Codec::decode(buffer, value, ByteOrder::needsFlip(Order));
+    }
+
+    /// \brief Write a struct with a ByteBufferWriter.
+    /// \param writer The writer to write to.
+    /// \param value The struct to write.
+    /// \returns The number of bytes written, which is SIZE or 0 if there is
+    ///     no room.
+    static std::size_t write(ByteBufferWriter& writer, const StructType& value)
+    {
+        uint8_t* buffer = writer.reserveBytes(SIZE);
+
+        if (buffer == nullptr)
+        {
+            return 0;
+        }
+
+        encode(value, buffer);
+        return writer.commitBytes(SIZE);
+    }
+
+    /// \brief Read a struct with a ByteBufferReader.
+    /// \param reader The reader to read from.
+    /// \param value The struct to fill.
+    /// \returns The number of bytes read, which is SIZE or 0 if too few
+    ///     bytes remain.
+    static std::size_t read(const ByteBufferReader& reader, StructType& value)
+    {
+        ByteBufferView view = reader.readView(SIZE);
+
+        if (view.size() != static_cast<std::size_t>(SIZE))
+        {
+            return 0;
+        }
+
+        decode(view.getPtr(), value);
+        return SIZE;
+    }
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,225 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+#include <type_traits>
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Variable-length (LEB128) and zigzag integer encoding.
+///
+/// A varint stores an unsigned integer seven bits per byte, least significant
+/// group first, with the high bit of each byte set if more bytes follow.
+/// Values below 128 take a single byte and a 64-bit value takes at most
+/// MAX_ENCODED_SIZE bytes.  This is the encoding used by Protocol Buffers.
+///
+/// Signed integers are first zigzag encoded so that values of small magnitude
+/// stay small: 0, -1, 1, -2, 2 ... map to 0, 1, 2, 3, 4 ...
+///
+/// \sa https://developers.google.com/protocol-buffers/docs/encoding#varints
+class VarintEncoding
+{
+public:
+    enum
+    {
+        /// \brief The maximum number of bytes in an encoded 64-bit value.
+        MAX_ENCODED_SIZE = 10
+    };
+
+    /// \brief Get the encoded size of a value.
+    /// \param value The value to measure.
+    /// \returns the number of bytes needed to encode the value.
+    static std::size_t encodedSize(uint64_t value);
+
+    /// \brief Encode a value.
+    /// \param value The value to encode.
+    /// \param encodedBuffer The target buffer for the encoded bytes.
+    /// \returns The number of bytes in the encoded value.
+    /// \warning encodedBuffer must have a minimum capacity of
+    ///     encodedSize(value).
+    static std::size_t encode(uint64_t value, uint8_t* encodedBuffer);
+
+    /// \brief Decode a value.
+    ///
+    /// When at least 8 bytes are available, values of up to 8 bytes are
+    /// decoded without a branch per byte.
+    ///
+    /// \param buffer The encoded bytes.
+    /// \param size The number of bytes available in the buffer.
+    /// \param value The decoded value.
+    /// \returns The number of bytes consumed or 0 if the value is truncated
+    ///     or does not fit in 64 bits.
+    static std::size_t decode(const uint8_t* buffer,
+                              std::size_t size,
+                              uint64_t& value);
+
+    /// \brief Zigzag encode a signed value.
+    /// \param value The value to encode.
+    /// \returns the encoded value.
+    static uint64_t encodeZigZag(int64_t value);
+
+    /// \brief Zigzag decode a signed value.
+    /// \param value The value to decode.
+    /// \returns the decoded value.
+    static int64_t decodeZigZag(uint64_t value);
+
+    /// \brief Convert an integer to its unsigned varint representation.
+    ///
+    /// Signed integers are zigzag encoded.
+    ///
+    /// \tparam Type An integral type.
+    /// \param value The value to convert.
+    /// \returns the unsigned value to encode.
+    template <typename Type>
+    static uint64_t fromInteger(Type value);
+
+    /// \brief Convert a decoded varint to an integer.
+    ///
+    /// Signed integers are zigzag decoded.
+    ///
+    /// \tparam Type An integral type.
+    /// \param encoded The decoded varint.
+    /// \param value The converted value.
+    /// \returns true iff the value fits in Type.
+    template <typename Type>
+    static bool toInteger(uint64_t encoded, Type& value);
+
+private:
+    template <typename Type>
+    static uint64_t _fromInteger(Type value, std::true_type);
+
+    template <typename Type>
+    static uint64_t _fromInteger(Type value, std::false_type);
+
+    template <typename Type>
+    static bool _toInteger(uint64_t encoded, Type& value, std::true_type);
+
+    template <typename Type>
+    static bool _toInteger(uint64_t encoded, Type& value, std::false_type);
+
+};
+
+
+inline std::size_t VarintEncoding::encodedSize(uint64_t value)
+{
+#if defined(__GNUC__)
+    // One byte per started group of seven significant bits.
+    std::size_t bits = 64 - static_cast<std::size_t>(__builtin_clzll(value | 1));
+    return (bits + 6) / 7;
+#else
+    std::size_t size = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        ++size;
+    }
+
+    return size;
+#endif
+}
+
+
+inline uint64_t VarintEncoding::encodeZigZag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^
+            static_cast<uint64_t>(value >> 63);
+}
+
+
+inline int64_t VarintEncoding::decodeZigZag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+
+template <typename Type>
+uint64_t VarintEncoding::fromInteger(Type value)
+{
+    static_assert(std::is_integral<Type>::value, "Type must be integral.");
+    return _fromInteger(value, std::is_signed<Type>());
+}
+
+
+template <typename Type>
+bool VarintEncoding::toInteger(uint64_t encoded, Type& value)
+{
+    static_assert(std::is_integral<Type>::value, "Type must be integral.");
+    return _toInteger(encoded, value, std::is_signed<Type>());
+}
+
+
+template <typename Type>
+uint64_t VarintEncoding::_fromInteger(Type value, std::true_type)
+{
+    return encodeZigZag(static_cast<int64_t>(value));
+}
+
+
+template <typename Type>
+uint64_t VarintEncoding::_fromInteger(Type value, std::false_type)
+{
+    return static_cast<uint64_t>(value);
+}
+
+
+template <typename Type>
+bool VarintEncoding::_toInteger(uint64_t encoded, Type& value, std::true_type)
+{
+    int64_t decoded = decodeZigZag(encoded);
+
+    if (decoded < static_cast<int64_t>(std::numeric_limits<Type>::min()) ||
+        decoded > static_cast<int64_t>(std::numeric_limits<Type>::max()))
+    {
+        return false;
+    }
+
+    value = static_cast<Type>(decoded);
+    return true;
+}
+
+
+template <typename Type>
+bool VarintEncoding::_toInteger(uint64_t encoded, Type& value, std::false_type)
+{
+    if (encoded > static_cast<uint64_t>(std::numeric_limits<Type>::max()))
+    {
+        return false;
+    }
+
+    value = static_cast<Type>(encoded);
+    return true;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,56 @@
+// =============================================================================
+//
+// Copyright (c) 2010-2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/AbstractTypes.h"
+#include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferView.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+std::size_t AbstractByteEncoder::encode(const ByteBufferView& buffer,
+                                        ByteBuffer& encodedBuffer)
+{
+    return encode(ByteBuffer(buffer.getPtr(), buffer.size()), encodedBuffer);
+}
+
+
+std::size_t AbstractByteDecoder::decode(const ByteBufferView& buffer,
+                                        ByteBuffer& decodedBuffer)
+{
+    return decode(ByteBuffer(buffer.getPtr(), buffer.size()), decodedBuffer);
+}
+
+
+std::size_t AbstractByteDecoder::decode(ByteBuffer&& buffer,
+                                        ByteBuffer& decodedBuffer)
+{
+    return decode(static_cast<const ByteBuffer&>(buffer), decodedBuffer);
+}
+
+
+} }  // namespace ofx::IO
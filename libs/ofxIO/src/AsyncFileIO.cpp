@@ -0,0 +1,485 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/AsyncFileIO.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "Poco/Exception.h"
+#include "Poco/FileStream.h"
+
+
+#if defined(POCO_OS_FAMILY_UNIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+struct AsyncFileIO::Task
+{
+    Task(bool isLoad,
+         const std::string& path,
+         std::size_t offset,
+         std::size_t size,
+         int options):
+        isLoad(isLoad),
+        path(path),
+        offset(offset),
+        size(size),
+        options(options)
+    {
+    }
+
+    /// \brief True for a load, false for a save.
+    bool isLoad;
+
+    /// \brief The path of the file.
+    std::string path;
+
+    /// \brief The offset of the first byte to load.
+    std::size_t offset;
+
+    /// \brief The number of bytes to load or save.
+    std::size_t size;
+
+    /// \brief The save options.
+    int options;
+
+    /// \brief The bytes to save.
+    ByteBuffer buffer;
+
+    /// \brief The result of a load.
+    std::promise<ByteBuffer> loadPromise;
+
+    /// \brief The result of a save.
+    std::promise<bool> savePromise;
+};
+
+
+AsyncFileIO::LoadRequest::LoadRequest(const std::string& path_,
+                                      std::size_t offset_,
+                                      std::size_t size_):
+    path(path_),
+    offset(offset_),
+    size(size_)
+{
+}
+
+
+AsyncFileIO::SaveRequest::SaveRequest(const std::string& path_,
+                                      ByteBuffer buffer_,
+                                      int options_):
+    path(path_),
+    buffer(std::move(buffer_)),
+    options(options_)
+{
+}
+
+
+AsyncFileIO::AsyncFileIO(std::size_t numThreads,
+                         std::size_t maxBytesInFlight):
+    _maxBytesInFlight(maxBytesInFlight),
+    _bytesInFlight(0),
+    _loadBytesInFlight(0),
+    _numPendingRequests(0),
+    _stopping(false)
+{
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < numThreads; ++i)
+    {
+        _threads.push_back(std::thread(&AsyncFileIO::_run, this));
+    }
+}
+
+
+AsyncFileIO::~AsyncFileIO()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _taskAvailable.notify_all();
+
+    for (auto& thread: _threads)
+    {
+        thread.join();
+    }
+}
+
+
+std::future<ByteBuffer> AsyncFileIO::load(const LoadRequest& request)
+{
+    return std::move(load(std::vector<LoadRequest>(1, request))[0]);
+}
+
+
+std::vector<std::future<ByteBuffer>> AsyncFileIO::load(const std::vector<LoadRequest>& requests)
+{
+    std::vector<std::unique_ptr<Task>> tasks;
+    std::vector<std::future<ByteBuffer>> futures;
+
+    for (const auto& request: requests)
+    {
+        std::unique_ptr<Task> task(new Task(true,
+                                            request.path,
+                                            request.offset,
+                                            request.size,
+                                            0));
+        futures.push_back(task->loadPromise.get_future());
+        tasks.push_back(std::move(task));
+    }
+
+    _enqueue(tasks);
+
+    return futures;
+}
+
+
+std::future<bool> AsyncFileIO::save(SaveRequest request)
+{
+    std::vector<SaveRequest> requests;
+    requests.push_back(std::move(request));
+    return std::move(save(std::move(requests))[0]);
+}
+
+
+std::vector<std::future<bool>> AsyncFileIO::save(std::vector<SaveRequest> requests)
+{
+    std::vector<std::unique_ptr<Task>> tasks;
+    std::vector<std::future<bool>> futures;
+
+    for (auto& request: requests)
+    {
+        std::unique_ptr<Task> task(new Task(false,
+                                            request.path,
+                                            0,
+                                            request.buffer.size(),
+                                            request.options));
+        task->buffer = std::move(request.buffer);
+        futures.push_back(task->savePromise.get_future());
+        tasks.push_back(std::move(task));
+    }
+
+    _enqueue(tasks);
+
+    return futures;
+}
+
+
+void AsyncFileIO::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _progress.wait(lock, [this] { return _numPendingRequests == 0; });
+}
+
+
+std::size_t AsyncFileIO::getNumPendingRequests() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _numPendingRequests;
+}
+
+
+std::size_t AsyncFileIO::getBytesInFlight() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _bytesInFlight;
+}
+
+
+std::size_t AsyncFileIO::getMaxBytesInFlight() const
+{
+    return _maxBytesInFlight;
+}
+
+
+std::size_t AsyncFileIO::getNumThreads() const
+{
+    return _threads.size();
+}
+
+
+void AsyncFileIO::_enqueue(std::vector<std::unique_ptr<Task>>& tasks)
+{
+    std::stable_sort(tasks.begin(),
+                     tasks.end(),
+                     [](const std::unique_ptr<Task>& lhs,
+                        const std::unique_ptr<Task>& rhs)
+                     {
+                         if (lhs->path != rhs->path) return lhs->path < rhs->path;
+                         return lhs->offset < rhs->offset;
+                     });
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto& task: tasks)
+    {
+        // A save holds its buffer while queued, so it is counted now.  Each
+        // save is queued as soon as it fits so that a batch larger than the
+        // bound drains behind itself.
+        if (!task->isLoad)
+        {
+            _acquireBytes(lock, task->size, false);
+        }
+
+        _tasks.push_back(std::move(task));
+        ++_numPendingRequests;
+        _taskAvailable.notify_one();
+    }
+}
+
+
+void AsyncFileIO::_acquireBytes(std::unique_lock<std::mutex>& lock,
+                                std::size_t bytes,
+                                bool isLoad)
+{
+    _progress.wait(lock, [this, bytes, isLoad]
+    {
+        // Running loads never wait, so a load that waits only on other loads
+        // cannot deadlock behind queued saves.
+        return (isLoad ? _loadBytesInFlight : _bytesInFlight) == 0
+            || _bytesInFlight + bytes <= _maxBytesInFlight;
+    });
+
+    _bytesInFlight += bytes;
+
+    if (isLoad)
+    {
+        _loadBytesInFlight += bytes;
+    }
+}
+
+
+void AsyncFileIO::_releaseBytes(std::size_t bytes, bool isLoad)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _bytesInFlight -= bytes;
+
+        if (isLoad)
+        {
+            _loadBytesInFlight -= bytes;
+        }
+    }
+
+    _progress.notify_all();
+}
+
+
+void AsyncFileIO::_load(Task& task)
+{
+    ByteBuffer buffer;
+    std::size_t claimed = 0;
+
+    try
+    {
+#if defined(POCO_OS_FAMILY_UNIX)
+        int fd = -1;
+
+        do
+        {
+            fd = ::open(task.path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        while (fd < 0 && errno == EINTR);
+
+        if (fd < 0)
+        {
+            switch (errno)
+            {
+                case ENOENT:
+                    throw Poco::FileNotFoundException(task.path);
+                case EACCES:
+                    throw Poco::FileAccessDeniedException(task.path);
+                default:
+                    throw Poco::OpenFileException(task.path, std::strerror(errno));
+            }
+        }
+
+        try
+        {
+            struct stat status;
+
+            if (::fstat(fd, &status) != 0)
+            {
+                throw Poco::ReadFileException(task.path, std::strerror(errno));
+            }
+
+            if (S_ISREG(status.st_mode) && status.st_size > 0)
+            {
+                std::size_t fileSize = static_cast<std::size_t>(status.st_size);
+                std::size_t available = task.offset < fileSize ? fileSize - task.offset : 0;
+                std::size_t size = task.size == 0 ? available : std::min(task.size, available);
+
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _acquireBytes(lock, size, true);
+                    claimed = size;
+                }
+
+                uint8_t* data = buffer.resizeUninitialized(size);
+                std::size_t total = 0;
+
+                while (total < size)
+                {
+                    ssize_t result = ::pread(fd,
+                                             data + total,
+                                             size - total,
+                                             static_cast<off_t>(task.offset + total));
+
+                    if (result < 0)
+                    {
+                        if (errno == EINTR) continue;
+                        throw Poco::ReadFileException(task.path, std::strerror(errno));
+                    }
+                    else if (result == 0)
+                    {
+                        // The file shrank while loading.
+                        break;
+                    }
+
+                    total += static_cast<std::size_t>(result);
+                }
+
+                buffer.resize(total);
+            }
+            else
+            {
+                // Special and empty files may report no size, so read them
+                // in order.
+                ByteBufferUtils::loadFromFile(task.path, buffer);
+
+                std::size_t begin = std::min(task.offset, buffer.size());
+                std::size_t end = task.size == 0 ? buffer.size() : std::min(begin + task.size, buffer.size());
+                buffer = ByteBuffer(buffer.getPtr() + begin, end - begin);
+            }
+        }
+        catch (...)
+        {
+            ::close(fd);
+            throw;
+        }
+
+        ::close(fd);
+#else
+        Poco::FileInputStream fis(task.path);
+        fis.seekg(0, std::ios::end);
+        std::size_t fileSize = static_cast<std::size_t>(fis.tellg());
+        std::size_t available = task.offset < fileSize ? fileSize - task.offset : 0;
+        std::size_t size = task.size == 0 ? available : std::min(task.size, available);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _acquireBytes(lock, size, true);
+            claimed = size;
+        }
+
+        fis.seekg(static_cast<std::streamoff>(task.offset), std::ios::beg);
+        uint8_t* data = buffer.resizeUninitialized(size);
+        fis.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+        buffer.resize(static_cast<std::size_t>(fis.gcount()));
+#endif
+
+        task.loadPromise.set_value(std::move(buffer));
+    }
+    catch (...)
+    {
+        task.loadPromise.set_exception(std::current_exception());
+    }
+
+    if (claimed > 0)
+    {
+        _releaseBytes(claimed, true);
+    }
+}
+
+
+void AsyncFileIO::_save(Task& task)
+{
+    try
+    {
+        task.savePromise.set_value(ByteBufferUtils::writeToFile(task.buffer,
+                                                                task.path,
+                                                                task.options));
+    }
+    catch (...)
+    {
+        task.savePromise.set_exception(std::current_exception());
+    }
+
+    // Free the buffer before releasing its bytes.
+    ByteBuffer().swap(task.buffer);
+    _releaseBytes(task.size, false);
+}
+
+
+void AsyncFileIO::_run()
+{
+    for (;;)
+    {
+        std::unique_ptr<Task> task;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _taskAvailable.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+            if (_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        if (task->isLoad)
+        {
+            _load(*task);
+        }
+        else
+        {
+            _save(*task);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            --_numPendingRequests;
+        }
+
+        _progress.notify_all();
+    }
+}
+
+
+} }  // namespace ofx::IO
@@ -28,6 +28,8 @@
 #include "Poco/Base64Encoder.h"
 #include "Poco/Base64Decoder.h"
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferStream.h"
+#include "ofx/IO/ByteBufferView.h"
 
 
 namespace ofx {
@@ -47,25 +49,35 @@ Base64Encoding::~Base64Encoding()
 std::size_t Base64Encoding::encode(const ByteBuffer& buffer,
                                    ByteBuffer& encodedBuffer)
 {
-    std::ostringstream ss;
-    Poco::Base64Encoder _encoder(ss);
-    ByteBuffer byteBuffer(buffer.readBytes());
-    ByteBufferUtils::copyBufferToStream(byteBuffer, _encoder);
+    return encode(ByteBufferView(buffer), encodedBuffer);
+}
+
+
+std::size_t Base64Encoding::decode(const ByteBuffer& buffer,
+                                   ByteBuffer& decodedBuffer)
+{
+    return decode(ByteBufferView(buffer), decodedBuffer);
+}
+
+
+std::size_t Base64Encoding::encode(const ByteBufferView& buffer,
+                                   ByteBuffer& encodedBuffer)
+{
+    ByteBufferOutputStream ostr(encodedBuffer);
+    Poco::Base64Encoder _encoder(ostr);
+    ByteBufferUtils::copyBufferToStream(buffer, _encoder);
     _encoder.close(); // Flush bytes.
-    encodedBuffer.writeBytes(ss.str());
+    ostr.flush();
     return encodedBuffer.size();
 }
 
-std::size_t Base64Encoding::decode(const ByteBuffer& buffer,
+
+std::size_t Base64Encoding::decode(const ByteBufferView& buffer,
                                    ByteBuffer& decodedBuffer)
 {
-    ByteBuffer byteBuffer(buffer.readBytes());
-    std::stringstream ss;
-    ss << byteBuffer;
-    Poco::Base64Decoder _decoder(ss);
-    ByteBuffer decoded;
-    ByteBufferUtils::copyStreamToBuffer(_decoder, decoded);
-    decodedBuffer.writeBytes(decoded);
+    ByteBufferInputStream istr(buffer);
+    Poco::Base64Decoder _decoder(istr);
+    ByteBufferUtils::copyStreamToBuffer(_decoder, decodedBuffer);
     return decodedBuffer.size();
 }
 
@@ -0,0 +1,102 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/BitReader.h"
+#include <algorithm>
+
+
+namespace ofx {
+namespace IO {
+
+
+BitReader::BitReader(const ByteBufferView& buffer, ByteOrder::BitOrder order):
+    _data(buffer.getPtr()),
+    _size(buffer.size()),
+    _byteOffset(0),
+    _cache(0),
+    _cacheBits(0),
+    _order(order)
+{
+}
+
+
+std::size_t BitReader::readBit(bool& value)
+{
+    uint8_t bit = 0;
+    std::size_t n = readBits(1, bit);
+    value = (bit != 0);
+    return n;
+}
+
+
+std::size_t BitReader::skipBits(std::size_t numBits)
+{
+    if (numBits > remainingBits())
+    {
+        return 0;
+    }
+
+    std::size_t n = numBits;
+
+    if (n > _cacheBits)
+    {
+        // Drop the accumulator and skip whole bytes without loading them.
+        n -= _cacheBits;
+        _cache = 0;
+        _cacheBits = 0;
+        _byteOffset += n / 8;
+        n %= 8;
+    }
+
+    while (n > 0)
+    {
+        std::size_t k = std::min<std::size_t>(n, 56);
+        _read(k);
+        n -= k;
+    }
+
+    return numBits;
+}
+
+
+std::size_t BitReader::alignToByte()
+{
+    return skipBits(_cacheBits % 8);
+}
+
+
+std::size_t BitReader::getBitOffset() const
+{
+    return _byteOffset * 8 - _cacheBits;
+}
+
+
+std::size_t BitReader::remainingBits() const
+{
+    return (_size - _byteOffset) * 8 + _cacheBits;
+}
+
+
+} }  // namespace ofx::IO
@@ -0,0 +1,72 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/BitWriter.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+BitWriter::BitWriter(ByteBuffer& buffer, ByteOrder::BitOrder order):
+    _buffer(buffer),
+    _cache(0),
+    _cacheBits(0),
+    _bitsWritten(0),
+    _order(order)
+{
+}
+
+
+std::size_t BitWriter::writeBit(bool value)
+{
+    _write(1, value ? 1 : 0);
+    return 1;
+}
+
+
+std::size_t BitWriter::alignToByte()
+{
+    std::size_t padding = (8 - _cacheBits % 8) % 8;
+    _write(padding, 0);
+    return padding;
+}
+
+
+std::size_t BitWriter::flush()
+{
+    std::size_t padding = alignToByte();
+    _drain();
+    return padding;
+}
+
+
+std::size_t BitWriter::getBitOffset() const
+{
+    return _bitsWritten + _cacheBits;
+}
+
+
+} }  // namespace ofx::IO
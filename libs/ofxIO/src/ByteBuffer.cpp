@@ -24,6 +24,7 @@
 
 
 #include "ofx/IO/ByteBuffer.h"
+#include <cstring>
 
 
 #ifdef min
@@ -72,6 +73,54 @@ ByteBuffer::ByteBuffer(const std::string& buffer)
     writeBytes(buffer);
 }
 
+
+ByteBuffer::ByteBuffer(const AbstractByteSource& buffer)
+{
+    writeBytes(buffer);
+}
+
+
+ByteBuffer::ByteBuffer(Storage&& buffer):
+    _buffer(std::move(buffer))
+{
+}
+
+
+ByteBuffer::ByteBuffer(const ByteBuffer& that):
+    AbstractByteSource(),
+    AbstractByteSink(),
+    _buffer(that._buffer)
+{
+}
+
+
+ByteBuffer::ByteBuffer(ByteBuffer&& that) noexcept:
+    AbstractByteSource(),
+    AbstractByteSink(),
+    _buffer(std::move(that._buffer))
+{
+    that._buffer.clear();
+}
+
+
+ByteBuffer& ByteBuffer::operator = (const ByteBuffer& that)
+{
+    _buffer = that._buffer;
+    return *this;
+}
+
+
+ByteBuffer& ByteBuffer::operator = (ByteBuffer&& that) noexcept
+{
+    if (this != &that)
+    {
+        _buffer = std::move(that._buffer);
+        that._buffer.clear();
+    }
+
+    return *this;
+}
+
     
 ByteBuffer::~ByteBuffer()
 {
@@ -88,29 +137,33 @@ std::size_t ByteBuffer::readBytes(uint8_t* buffer, std::size_t size) const
 
 std::size_t ByteBuffer::readBytes(std::vector<uint8_t>& buffer) const
 {
-    buffer.resize(_buffer.size());
-    buffer.insert(buffer.begin(), _buffer.begin(), _buffer.end());
+    buffer.assign(_buffer.begin(), _buffer.end());
     return buffer.size();
 }
 
 
 std::size_t ByteBuffer::readBytes(std::string& buffer) const
 {
-    buffer.resize(_buffer.size());
-    buffer.insert(buffer.begin(), _buffer.begin(), _buffer.end());
+    buffer.assign(_buffer.begin(), _buffer.end());
     return buffer.size();
 }
 
 
 std::size_t ByteBuffer::readBytes(AbstractByteSink& buffer) const
 {
-    return buffer.writeBytes(_buffer);
+    return buffer.writeBytes(getPtr(), _buffer.size());
 }
 
 
 std::vector<uint8_t> ByteBuffer::readBytes() const
 {
-    return _buffer;
+    return std::vector<uint8_t>(_buffer.begin(), _buffer.end());
+}
+
+
+const uint8_t* ByteBuffer::getContiguousPtr() const
+{
+    return getPtr();
 }
 
 
@@ -123,31 +176,68 @@ std::size_t ByteBuffer::writeByte(uint8_t data)
 
 std::size_t ByteBuffer::writeBytes(const uint8_t* buffer, std::size_t size)
 {
-    _buffer.reserve(_buffer.size() + size);
-    _buffer.insert(_buffer.end(), buffer, buffer + size);
-    return size;
+    return _append(buffer, size);
 }
 
 
 std::size_t ByteBuffer::writeBytes(const std::vector<uint8_t>& buffer)
 {
-    _buffer.reserve(_buffer.size() + buffer.size());
-    _buffer.insert(_buffer.end(), buffer.begin(), buffer.end());
-    return buffer.size();
+    return _append(buffer.data(), buffer.size());
 }
 
 
 std::size_t ByteBuffer::writeBytes(const std::string& buffer)
 {
-    _buffer.reserve(_buffer.size() + buffer.size());
-    _buffer.insert(_buffer.end(), buffer.begin(), buffer.end());
-    return buffer.size();
+    return _append(reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
 }
 
 
 std::size_t ByteBuffer::writeBytes(const AbstractByteSource& buffer)
 {
-    return writeBytes(buffer.readBytes());
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+    if (!buffer.getChunk(0, data, size))
+    {
+        // The source can only be copied out.
+        return writeBytes(buffer.readBytes());
+    }
+
+    std::size_t total = 0;
+    std::size_t index = 0;
+
+    while (buffer.getChunk(index++, data, size))
+    {
+        total += _append(data, size);
+    }
+
+    return total;
+}
+
+
+std::size_t ByteBuffer::_append(const uint8_t* buffer, std::size_t size)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    const uint8_t* begin = _buffer.data();
+    const std::size_t oldSize = _buffer.size();
+
+    if (begin != nullptr && buffer >= begin && buffer < begin + _buffer.capacity())
+    {
+        // The bytes alias this buffer and may move when it grows.
+        const std::size_t offset = static_cast<std::size_t>(buffer - begin);
+        _buffer.resize(oldSize + size);
+        std::memmove(_buffer.data() + oldSize, _buffer.data() + offset, size);
+    }
+    else
+    {
+        _buffer.insert(_buffer.end(), buffer, buffer + size);
+    }
+
+    return size;
 }
 
 
@@ -182,6 +272,21 @@ std::size_t ByteBuffer::resize(std::size_t size, uint8_t fillByte)
 }
 
 
+uint8_t* ByteBuffer::resizeUninitialized(std::size_t size)
+{
+    _buffer.resize(size);
+    return getPtr();
+}
+
+
+uint8_t* ByteBuffer::appendUninitialized(std::size_t size)
+{
+    std::size_t offset = _buffer.size();
+    _buffer.resize(offset + size);
+    return _buffer.data() + offset;
+}
+
+
 std::size_t ByteBuffer::reserve(std::size_t capacity)
 {
     _buffer.reserve(capacity);
@@ -189,7 +294,21 @@ std::size_t ByteBuffer::reserve(std::size_t capacity)
 }
 
     
-const std::vector<uint8_t>& ByteBuffer::getData() const
+ByteBuffer::Storage ByteBuffer::release()
+{
+    Storage buffer;
+    buffer.swap(_buffer);
+    return buffer;
+}
+
+
+void ByteBuffer::swap(ByteBuffer& that) noexcept
+{
+    _buffer.swap(that._buffer);
+}
+
+
+const ByteBuffer::Storage& ByteBuffer::getData() const
 {
     return _buffer;
 }
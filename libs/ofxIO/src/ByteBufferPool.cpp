@@ -0,0 +1,457 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/ByteBufferPool.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+typedef std::vector<std::unique_ptr<ByteBuffer>> FreeList;
+
+
+/// \brief A single thread's cache of buffers for one pool.
+///
+/// Caches are owned by their pool, so their buffers are freed with the
+/// pool, but they are only ever used by their own thread.
+struct ThreadCache
+{
+    FreeList lists[ByteBufferPool::NUM_SIZE_CLASSES];
+};
+
+
+} // namespace
+
+
+struct ByteBufferPool::State
+{
+    State(std::size_t maxPooledBytes, std::size_t threadCacheSize):
+        id(nextId()),
+        maxPooledBytes(maxPooledBytes),
+        threadCacheSize(threadCacheSize),
+        acquireCount(0),
+        releaseCount(0),
+        hitCount(0),
+        missCount(0),
+        discardCount(0),
+        outstandingCount(0),
+        outstandingHighWaterMark(0),
+        pooledBytes(0),
+        pooledBytesHighWaterMark(0),
+        largestRequest(0)
+    {
+    }
+
+    /// \brief Try to account for bytes entering the pool.
+    /// \returns false if the bytes would exceed maxPooledBytes.
+    bool addPooledBytes(std::size_t bytes)
+    {
+        std::size_t current = pooledBytes.load();
+
+        do
+        {
+            if (current + bytes > maxPooledBytes)
+            {
+                return false;
+            }
+        }
+        while (!pooledBytes.compare_exchange_weak(current, current + bytes));
+
+        updateMax(pooledBytesHighWaterMark, current + bytes);
+        return true;
+    }
+
+    /// \brief Account for bytes leaving the pool.
+    void removePooledBytes(std::size_t bytes)
+    {
+        pooledBytes -= bytes;
+    }
+
+    /// \brief Create a cache for the calling thread.
+    /// \returns the new cache, owned by the pool.
+    ThreadCache* addThreadCache()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        threadCaches.emplace_back(new ThreadCache());
+        return threadCaches.back().get();
+    }
+
+    /// \brief Move a thread's cached buffers to the free lists and destroy
+    ///        its cache.
+    void removeThreadCache(ThreadCache* cache)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (std::size_t i = 0; i < ByteBufferPool::NUM_SIZE_CLASSES; ++i)
+        {
+            for (auto& buffer: cache->lists[i])
+            {
+                freeLists[i].push_back(std::move(buffer));
+            }
+        }
+
+        for (auto iter = threadCaches.begin(); iter != threadCaches.end(); ++iter)
+        {
+            if (iter->get() == cache)
+            {
+                threadCaches.erase(iter);
+                break;
+            }
+        }
+    }
+
+    /// \brief Raise a high-water mark to at least value.
+    static void updateMax(std::atomic<std::size_t>& mark, std::size_t value)
+    {
+        std::size_t current = mark.load();
+
+        while (current < value && !mark.compare_exchange_weak(current, value))
+        {
+        }
+    }
+
+    /// \returns a unique id used to key per-thread caches.
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> counter(0);
+        return ++counter;
+    }
+
+    const uint64_t id;
+    const std::size_t maxPooledBytes;
+    const std::size_t threadCacheSize;
+
+    std::mutex mutex;
+    FreeList freeLists[NUM_SIZE_CLASSES];
+
+    /// \brief The caches of the threads that have used the pool.
+    std::vector<std::unique_ptr<ThreadCache>> threadCaches;
+
+    std::atomic<std::size_t> acquireCount;
+    std::atomic<std::size_t> releaseCount;
+    std::atomic<std::size_t> hitCount;
+    std::atomic<std::size_t> missCount;
+    std::atomic<std::size_t> discardCount;
+    std::atomic<std::size_t> outstandingCount;
+    std::atomic<std::size_t> outstandingHighWaterMark;
+    std::atomic<std::size_t> pooledBytes;
+    std::atomic<std::size_t> pooledBytesHighWaterMark;
+    std::atomic<std::size_t> largestRequest;
+};
+
+
+namespace {
+
+
+/// \brief The calling thread's caches, keyed by pool id.
+struct ThreadCacheMap
+{
+    /// \brief A cache and the pool that owns it.
+    struct Entry
+    {
+        std::weak_ptr<ByteBufferPool::State> state;
+        ThreadCache* cache;
+    };
+
+    ~ThreadCacheMap()
+    {
+        // Hand the cached buffers back to the pools that are still alive.
+        // The caches of destroyed pools were freed with them.
+        for (auto& entry: entries)
+        {
+            std::shared_ptr<ByteBufferPool::State> pool = entry.second.state.lock();
+
+            if (pool != nullptr)
+            {
+                pool->removeThreadCache(entry.second.cache);
+            }
+        }
+    }
+
+    std::map<uint64_t, Entry> entries;
+};
+
+
+/// \returns the calling thread's cache for the given pool.
+ThreadCache& getThreadCache(const std::shared_ptr<ByteBufferPool::State>& state)
+{
+    static thread_local ThreadCacheMap caches;
+
+    auto found = caches.entries.find(state->id);
+
+    if (found != caches.entries.end())
+    {
+        return *found->second.cache;
+    }
+
+    // Drop the entries of pools that no longer exist.
+    auto iter = caches.entries.begin();
+
+    while (iter != caches.entries.end())
+    {
+        if (iter->second.state.expired())
+        {
+            iter = caches.entries.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    ThreadCacheMap::Entry& entry = caches.entries[state->id];
+    entry.state = state;
+    entry.cache = state->addThreadCache();
+    return *entry.cache;
+}
+
+
+/// \returns the smallest size class that holds at least capacity bytes, or
+///          NUM_SIZE_CLASSES if capacity is too large to be pooled.
+std::size_t sizeClassForRequest(std::size_t capacity)
+{
+    std::size_t sizeClass = 0;
+    std::size_t size = ByteBufferPool::MIN_BUFFER_SIZE;
+
+    while (size < capacity && sizeClass < ByteBufferPool::NUM_SIZE_CLASSES)
+    {
+        size <<= 1;
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
+
+
+/// \returns the largest size class whose size does not exceed capacity, or
+///          NUM_SIZE_CLASSES if the capacity cannot be pooled.
+std::size_t sizeClassForCapacity(std::size_t capacity)
+{
+    if (capacity < ByteBufferPool::MIN_BUFFER_SIZE)
+    {
+        return ByteBufferPool::NUM_SIZE_CLASSES;
+    }
+
+    std::size_t sizeClass = 0;
+    std::size_t size = ByteBufferPool::MIN_BUFFER_SIZE;
+
+    while ((size << 1) <= capacity && sizeClass < ByteBufferPool::NUM_SIZE_CLASSES)
+    {
+        size <<= 1;
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
+
+
+} // namespace
+
+
+ByteBufferPool::ByteBufferPool(std::size_t maxPooledBytes,
+                               std::size_t threadCacheSize):
+    _state(std::make_shared<State>(maxPooledBytes, threadCacheSize))
+{
+}
+
+
+ByteBufferPool::~ByteBufferPool()
+{
+}
+
+
+std::unique_ptr<ByteBuffer> ByteBufferPool::acquire(std::size_t capacity)
+{
+    ++_state->acquireCount;
+    State::updateMax(_state->largestRequest, capacity);
+    State::updateMax(_state->outstandingHighWaterMark, ++_state->outstandingCount);
+
+    std::unique_ptr<ByteBuffer> buffer;
+    std::size_t sizeClass = sizeClassForRequest(capacity);
+
+    if (sizeClass < NUM_SIZE_CLASSES)
+    {
+        if (_state->threadCacheSize > 0)
+        {
+            FreeList& list = getThreadCache(_state).lists[sizeClass];
+
+            if (!list.empty())
+            {
+                buffer = std::move(list.back());
+                list.pop_back();
+            }
+        }
+
+        if (buffer == nullptr)
+        {
+            std::unique_lock<std::mutex> lock(_state->mutex);
+            FreeList& list = _state->freeLists[sizeClass];
+
+            if (!list.empty())
+            {
+                buffer = std::move(list.back());
+                list.pop_back();
+            }
+        }
+    }
+
+    if (buffer != nullptr)
+    {
+        ++_state->hitCount;
+        _state->removePooledBytes(buffer->capacity());
+    }
+    else
+    {
+        ++_state->missCount;
+        buffer.reset(new ByteBuffer());
+
+        // Round up to the size class so that the buffer is reusable for any
+        // request in the same class.
+        if (sizeClass < NUM_SIZE_CLASSES)
+        {
+            buffer->reserve(std::size_t(MIN_BUFFER_SIZE) << sizeClass);
+        }
+        else
+        {
+            buffer->reserve(capacity);
+        }
+    }
+
+    return buffer;
+}
+
+
+void ByteBufferPool::release(std::unique_ptr<ByteBuffer> buffer)
+{
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    ++_state->releaseCount;
+
+    std::size_t outstanding = _state->outstandingCount.load();
+
+    while (outstanding > 0 &&
+           !_state->outstandingCount.compare_exchange_weak(outstanding, outstanding - 1))
+    {
+    }
+
+    buffer->clear();
+
+    std::size_t capacity = buffer->capacity();
+    std::size_t sizeClass = sizeClassForCapacity(capacity);
+
+    if (sizeClass >= NUM_SIZE_CLASSES || !_state->addPooledBytes(capacity))
+    {
+        ++_state->discardCount;
+        return;
+    }
+
+    if (_state->threadCacheSize > 0)
+    {
+        FreeList& list = getThreadCache(_state).lists[sizeClass];
+
+        if (list.size() < _state->threadCacheSize)
+        {
+            list.push_back(std::move(buffer));
+            return;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->freeLists[sizeClass].push_back(std::move(buffer));
+}
+
+
+void ByteBufferPool::clear()
+{
+    if (_state->threadCacheSize > 0)
+    {
+        ThreadCache& cache = getThreadCache(_state);
+
+        for (std::size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+        {
+            for (auto& buffer: cache.lists[i])
+            {
+                _state->removePooledBytes(buffer->capacity());
+            }
+
+            cache.lists[i].clear();
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(_state->mutex);
+
+    for (std::size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+    {
+        for (auto& buffer: _state->freeLists[i])
+        {
+            _state->removePooledBytes(buffer->capacity());
+        }
+
+        _state->freeLists[i].clear();
+    }
+}
+
+
+ByteBufferPool::Statistics ByteBufferPool::getStatistics() const
+{
+    Statistics statistics;
+    statistics.acquireCount = _state->acquireCount.load();
+    statistics.releaseCount = _state->releaseCount.load();
+    statistics.hitCount = _state->hitCount.load();
+    statistics.missCount = _state->missCount.load();
+    statistics.discardCount = _state->discardCount.load();
+    statistics.outstandingCount = _state->outstandingCount.load();
+    statistics.outstandingHighWaterMark = _state->outstandingHighWaterMark.load();
+    statistics.pooledBytes = _state->pooledBytes.load();
+    statistics.pooledBytesHighWaterMark = _state->pooledBytesHighWaterMark.load();
+    statistics.largestRequest = _state->largestRequest.load();
+    return statistics;
+}
+
+
+std::size_t ByteBufferPool::getMaxPooledBytes() const
+{
+    return _state->maxPooledBytes;
+}
+
+
+std::size_t ByteBufferPool::getThreadCacheSize() const
+{
+    return _state->threadCacheSize;
+}
+
+
+} }  // namespace ofx::IO
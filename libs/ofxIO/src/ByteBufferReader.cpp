@@ -33,7 +33,15 @@ namespace IO {
 
 
 ByteBufferReader::ByteBufferReader(const ByteBuffer& buffer, std::size_t offset):
-    _buffer(buffer),
+    _buffer(&buffer),
+    _offset(offset)
+{
+}
+
+
+ByteBufferReader::ByteBufferReader(const ByteBufferView& buffer, std::size_t offset):
+    _buffer(nullptr),
+    _bufferView(buffer),
     _offset(offset)
 {
 }
@@ -41,10 +49,19 @@ ByteBufferReader::ByteBufferReader(const ByteBuffer& buffer, std::size_t offset)
 
 std::size_t ByteBufferReader::_read(void* destination, std::size_t size) const
 {
-    if (_offset + size <= _buffer.size())
+    std::size_t n = _peek(destination, size);
+    _offset += n;
+    return n;
+}
+
+
+std::size_t ByteBufferReader::_peek(void* destination, std::size_t size) const
+{
+    ByteBufferView view = _view();
+
+    if (_offset <= view.size() && size <= view.size() - _offset)
     {
-        std::memcpy(destination, _buffer.getPtr() + _offset, size);
-        _offset += size;
+        if (size > 0) std::memcpy(destination, view.getPtr() + _offset, size);
         return size;
     }
     else
@@ -54,15 +71,82 @@ std::size_t ByteBufferReader::_read(void* destination, std::size_t size) const
 }
 
 
+ByteBufferView ByteBufferReader::readView(std::size_t size) const
+{
+    ByteBufferView view = peekView(size);
+    _offset += view.size();
+    return view;
+}
+
+
+ByteBufferView ByteBufferReader::peekView(std::size_t size) const
+{
+    ByteBufferView view = _view();
+
+    if (_offset <= view.size() && size <= view.size() - _offset)
+    {
+        return ByteBufferView(view.getPtr() + _offset, size);
+    }
+    else
+    {
+        return ByteBufferView();
+    }
+}
+
+
+std::size_t ByteBufferReader::_readOrdered(void* destination,
+                                           std::size_t count,
+                                           std::size_t width,
+                                           bool flip) const
+{
+    ByteBufferView view = _view();
+
+    // Check the count before multiplying, so that the size cannot overflow.
+    if (_offset > view.size() || count > (view.size() - _offset) / width)
+    {
+        return 0;
+    }
+
+    std::size_t size = count * width;
+    const uint8_t* source = view.getPtr() + _offset;
+
+    if (!flip || width == 1)
+    {
+        if (size > 0) std::memcpy(destination, source, size);
+    }
+    else if (width == 2)
+    {
+        ByteOrder::flipBytes16(destination, source, count);
+    }
+    else if (width == 4)
+    {
+        ByteOrder::flipBytes32(destination, source, count);
+    }
+    else
+    {
+        ByteOrder::flipBytes64(destination, source, count);
+    }
+
+    _offset += size;
+    return size;
+}
+
+
+ByteBufferView ByteBufferReader::_view() const
+{
+    return _buffer != nullptr ? ByteBufferView(*_buffer) : _bufferView;
+}
+
+
 void ByteBufferReader::setOffset(std::size_t offset)
 {
-    if (offset < _buffer.size()) _offset = offset;
+    if (offset < size()) _offset = offset;
 }
 
 
 void ByteBufferReader::skip(std::size_t offset)
 {
-    if (_offset + offset < _buffer.size()) _offset += offset;
+    if (_offset < size() && offset < size() - _offset) _offset += offset;
 }
 
 
@@ -74,13 +158,13 @@ std::size_t ByteBufferReader::getOffset() const
 
 std::size_t ByteBufferReader::size() const
 {
-    return _buffer.size();
+    return _buffer != nullptr ? _buffer->size() : _bufferView.size();
 }
 
 
 std::size_t ByteBufferReader::remaining() const
 {
-    return _buffer.size() - _offset;
+    return _offset < size() ? size() - _offset : 0;
 }
 
 
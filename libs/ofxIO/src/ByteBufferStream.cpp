@@ -24,6 +24,8 @@
 
 
 #include "ofx/IO/ByteBufferStream.h"
+#include <algorithm>
+#include <cstring>
 
 
 namespace ofx {
@@ -31,9 +33,16 @@ namespace IO {
 
 
 ByteBufferInputStreamBuf::ByteBufferInputStreamBuf(const ByteBuffer& buffer,
-                                                   std::size_t offset):
-    _bufferReader(buffer, offset)
+                                                   std::size_t offset)
 {
+    _setView(ByteBufferView(buffer), offset);
+}
+
+
+ByteBufferInputStreamBuf::ByteBufferInputStreamBuf(const ByteBufferView& buffer,
+                                                   std::size_t offset)
+{
+    _setView(buffer, offset);
 }
 
 
@@ -42,42 +51,157 @@ ByteBufferInputStreamBuf::~ByteBufferInputStreamBuf()
 }
 
 
-int ByteBufferInputStreamBuf::readFromDevice()
+ByteBufferInputStreamBuf::int_type ByteBufferInputStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    return traits_type::eof();
+}
+
+
+std::streamsize ByteBufferInputStreamBuf::xsgetn(char_type* buffer,
+                                                 std::streamsize size)
 {
-    char byte;
+    std::streamsize n = std::min<std::streamsize>(egptr() - gptr(), size);
 
-    if (_bufferReader.read(byte) > 0)
+    if (n > 0)
     {
-        return charToInt(byte);
+        std::memcpy(buffer, gptr(), static_cast<std::size_t>(n));
+        setg(eback(), gptr() + n, egptr());
     }
-    else
+
+    return n;
+}
+
+
+std::streamsize ByteBufferInputStreamBuf::showmanyc()
+{
+    if (gptr() < egptr())
+    {
+        return egptr() - gptr();
+    }
+
+    return -1;
+}
+
+
+ByteBufferInputStreamBuf::pos_type ByteBufferInputStreamBuf::seekoff(off_type offset,
+                                                                     std::ios_base::seekdir direction,
+                                                                     std::ios_base::openmode which)
+{
+    if ((which & std::ios_base::in) == 0)
+    {
+        return pos_type(off_type(-1));
+    }
+
+    off_type base = 0;
+
+    if (direction == std::ios_base::cur)
+    {
+        base = gptr() - eback();
+    }
+    else if (direction == std::ios_base::end)
+    {
+        base = egptr() - eback();
+    }
+
+    off_type position = base + offset;
+
+    if (position < 0 || position > egptr() - eback())
     {
-        return char_traits::eof();
+        return pos_type(off_type(-1));
     }
+
+    setg(eback(), eback() + position, egptr());
+    return pos_type(position);
+}
+
+
+ByteBufferInputStreamBuf::pos_type ByteBufferInputStreamBuf::seekpos(pos_type position,
+                                                                     std::ios_base::openmode which)
+{
+    return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+
+void ByteBufferInputStreamBuf::_setView(const ByteBufferView& view,
+                                        std::size_t offset)
+{
+    // The get area is never written to.
+    char* begin = const_cast<char*>(view.getCharPtr());
+    offset = std::min(offset, view.size());
+    setg(begin, begin + offset, begin + view.size());
 }
 
 
 ByteBufferOutputStreamBuf::ByteBufferOutputStreamBuf(ByteBuffer& buffer):
     _buffer(buffer)
 {
+    setp(_block, _block + DEFAULT_BUFFER_SIZE);
 }
 
 
 ByteBufferOutputStreamBuf::~ByteBufferOutputStreamBuf()
 {
+    _flush();
+}
+
+
+ByteBufferOutputStreamBuf::int_type ByteBufferOutputStreamBuf::overflow(int_type c)
+{
+    _flush();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    return traits_type::not_eof(c);
 }
 
 
-int ByteBufferOutputStreamBuf::writeToDevice(char byte)
+std::streamsize ByteBufferOutputStreamBuf::xsputn(const char_type* buffer,
+                                                  std::streamsize size)
 {
-    if (_buffer.writeByte(byte) > 0)
+    if (size <= epptr() - pptr())
     {
-        return charToInt(byte);
+        std::memcpy(pptr(), buffer, static_cast<std::size_t>(size));
+        pbump(static_cast<int>(size));
     }
     else
     {
-        return char_traits::eof();
+        // Keep the bytes in order and skip the put area for large writes.
+        _flush();
+        _buffer.writeBytes(reinterpret_cast<const uint8_t*>(buffer),
+                           static_cast<std::size_t>(size));
+    }
+
+    return size;
+}
+
+
+int ByteBufferOutputStreamBuf::sync()
+{
+    _flush();
+    return 0;
+}
+
+
+void ByteBufferOutputStreamBuf::_flush()
+{
+    std::size_t size = static_cast<std::size_t>(pptr() - pbase());
+
+    if (size > 0)
+    {
+        _buffer.writeBytes(reinterpret_cast<const uint8_t*>(pbase()), size);
     }
+
+    setp(_block, _block + DEFAULT_BUFFER_SIZE);
 }
 
 
@@ -25,12 +25,32 @@
 
 #include "ofx/IO/ByteBufferUtils.h"
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferView.h"
 #include "Poco/Buffer.h"
+#include "Poco/Exception.h"
 #include "Poco/FileStream.h"
 #include <iostream> 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 #include "ofLog.h"
 
 
+#if defined(POCO_OS_FAMILY_UNIX)
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+
 namespace ofx {
 namespace IO {
 
@@ -88,36 +108,38 @@ std::streamsize ByteBufferUtils::copyStreamToBuffer(std::istream& istr,
 {
 	poco_assert (bufferSize > 0);
 
-    Poco::Buffer<char> buffer(bufferSize);
     std::streamsize len = 0;
-    istr.read(buffer.begin(), static_cast<std::streamsize>(bufferSize));
-    std::streamsize n = istr.gcount();
-
-    while (n > 0)
-	{
-		len += n;
-        byteBuffer.writeBytes(reinterpret_cast<uint8_t*>(buffer.begin()), static_cast<std::size_t>(n));
-        if (istr)
-		{
-			istr.read(buffer.begin(), static_cast<std::streamsize>(bufferSize));
-            n = istr.gcount();
-		}
-        else
-        {
-            n = 0;
-        }
-	}
-    
+    std::streamsize n = 0;
+
+    do
+    {
+        // Read directly into the tail of the ByteBuffer.
+        std::size_t offset = byteBuffer.size();
+        uint8_t* tail = byteBuffer.appendUninitialized(bufferSize);
+        istr.read(reinterpret_cast<char*>(tail), static_cast<std::streamsize>(bufferSize));
+        n = istr.gcount();
+        byteBuffer.resize(offset + static_cast<std::size_t>(n));
+        len += n;
+    }
+    while (n > 0 && istr);
+
 	return len;
 }
 
 
 std::ostream& ByteBufferUtils::copyBufferToStream(const ByteBuffer& byteBuffer,
                                                   std::ostream& ostr)
+{
+    return copyBufferToStream(ByteBufferView(byteBuffer), ostr);
+}
+
+
+std::ostream& ByteBufferUtils::copyBufferToStream(const ByteBufferView& view,
+                                                  std::ostream& ostr)
 {
     if (!ostr.bad())
     {
-        ostr.write(byteBuffer.getCharPtr(), static_cast<std::streamsize>(byteBuffer.size()));
+        ostr.write(view.getCharPtr(), static_cast<std::streamsize>(view.size()));
     }
     else
     {
@@ -128,11 +150,71 @@ std::ostream& ByteBufferUtils::copyBufferToStream(const ByteBuffer& byteBuffer,
 }
 
 
+std::ostream& ByteBufferUtils::copyBufferToStream(const AbstractByteSource& source,
+                                                  std::ostream& ostr)
+{
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+    if (!source.getChunk(0, data, size))
+    {
+        return copyBufferToStream(ByteBuffer(source.readBytes()), ostr);
+    }
+
+    std::size_t index = 0;
+
+    while (ostr.good() && source.getChunk(index++, data, size))
+    {
+        copyBufferToStream(ByteBufferView(data, size), ostr);
+    }
+
+    return ostr;
+}
+
+
 std::streamsize ByteBufferUtils::loadFromFile(const std::string& path,
                                               ByteBuffer& byteBuffer,
                                               bool appendBuffer,
                                               std::ios::openmode openMode)
 {
+#if defined(POCO_OS_FAMILY_UNIX)
+    // Seeking to the end on open is only meaningful for streams.
+    if ((openMode & std::ios::ate) == 0)
+    {
+        int fd = -1;
+
+        do
+        {
+            fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        while (fd < 0 && errno == EINTR);
+
+        // If the file can't be opened, the stream below reports the error.
+        if (fd >= 0)
+        {
+            if (!appendBuffer)
+            {
+                byteBuffer.clear();
+            }
+
+            std::streamsize n = 0;
+
+            try
+            {
+                n = _loadFromFileDescriptor(fd, byteBuffer);
+            }
+            catch (...)
+            {
+                ::close(fd);
+                throw;
+            }
+
+            ::close(fd);
+            return n;
+        }
+    }
+#endif
+
     Poco::FileInputStream fis(path, openMode);
 
     if (fis.good())
@@ -153,6 +235,252 @@ std::streamsize ByteBufferUtils::loadFromFile(const std::string& path,
 }
 
 
+std::size_t ByteBufferUtils::loadFromFileParallel(const std::string& path,
+                                                  ByteBuffer& buffer,
+                                                  const ChunkCallback& callback,
+                                                  std::size_t chunkSize,
+                                                  std::size_t numThreads)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    int fd = -1;
+
+    do
+    {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    while (fd < 0 && errno == EINTR);
+
+    struct stat status;
+
+    if (fd < 0 ||
+        ::fstat(fd, &status) != 0 ||
+        !S_ISREG(status.st_mode) ||
+        status.st_size == 0)
+    {
+        // Let the serial path report errors and handle special files, which
+        // may report a size of 0.
+        if (fd >= 0) ::close(fd);
+        std::size_t n = static_cast<std::size_t>(loadFromFile(path, buffer));
+        if (callback) callback(0, ByteBufferView(buffer));
+        return n;
+    }
+
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    chunkSize = std::max(chunkSize, pageSize);
+    chunkSize = (chunkSize + pageSize - 1) / pageSize * pageSize;
+
+    std::size_t numChunks = (size + chunkSize - 1) / chunkSize;
+
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    numThreads = std::min(numThreads, numChunks);
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    uint8_t* data = nullptr;
+
+    try
+    {
+        buffer.clear();
+        data = buffer.resizeUninitialized(size);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+
+    std::atomic<std::size_t> nextChunk(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto loadChunks = [&]()
+    {
+        try
+        {
+            std::size_t chunk = 0;
+
+            while (!failed && (chunk = nextChunk++) < numChunks)
+            {
+                std::size_t offset = chunk * chunkSize;
+                std::size_t length = std::min(chunkSize, size - offset);
+                std::size_t total = 0;
+
+                while (total < length)
+                {
+                    ssize_t result = ::pread(fd,
+                                             data + offset + total,
+                                             length - total,
+                                             static_cast<off_t>(offset + total));
+
+                    if (result < 0)
+                    {
+                        if (errno == EINTR) continue;
+                        throw Poco::ReadFileException(path, std::strerror(errno));
+                    }
+                    else if (result == 0)
+                    {
+                        throw Poco::ReadFileException(path, "File shrank while loading.");
+                    }
+
+                    total += static_cast<std::size_t>(result);
+                }
+
+                if (callback)
+                {
+                    callback(offset, ByteBufferView(data + offset, length));
+                }
+            }
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(errorMutex);
+
+            if (!failed.exchange(true))
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    // The calling thread loads chunks too.
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < numThreads; ++i)
+    {
+        try
+        {
+            threads.push_back(std::thread(loadChunks));
+        }
+        catch (const std::exception&)
+        {
+            // Continue with the threads that could be started.
+            break;
+        }
+    }
+
+    loadChunks();
+
+    for (std::size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+
+    ::close(fd);
+
+    if (error)
+    {
+        buffer.clear();
+        std::rethrow_exception(error);
+    }
+
+    return size;
+#else
+    std::size_t n = static_cast<std::size_t>(loadFromFile(path, buffer));
+    (void)chunkSize;
+    (void)numThreads;
+    if (callback) callback(0, ByteBufferView(buffer));
+    return n;
+#endif
+}
+
+
+std::streamsize ByteBufferUtils::_loadFromFileDescriptor(int fd,
+                                                         ByteBuffer& byteBuffer)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    // Linux transfers at most this many bytes per read.
+    const std::size_t maxReadSize = 0x7ffff000;
+
+    struct stat status;
+    std::size_t expected = 0;
+
+    // Special files may report a size of 0 and are read until EOF below.
+    if (::fstat(fd, &status) == 0 && S_ISREG(status.st_mode))
+    {
+        expected = static_cast<std::size_t>(status.st_size);
+    }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::size_t start = byteBuffer.size();
+    std::size_t total = 0;
+
+    // Reserve the exact size once and read directly into the buffer.
+    byteBuffer.reserve(start + expected);
+    uint8_t* data = byteBuffer.appendUninitialized(expected);
+
+    while (total < expected)
+    {
+        ssize_t result = ::read(fd,
+                                data + total,
+                                std::min(expected - total, maxReadSize));
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            int error = errno;
+            byteBuffer.resize(start + total);
+            throw Poco::ReadFileException(std::strerror(error));
+        }
+        else if (result == 0)
+        {
+            // The file was truncated after fstat().
+            break;
+        }
+
+        total += static_cast<std::size_t>(result);
+    }
+
+    byteBuffer.resize(start + total);
+
+    // Collect anything beyond the reported size, e.g. from a growing file.
+    uint8_t chunk[DEFAULT_BUFFER_SIZE];
+
+    for (;;)
+    {
+        ssize_t result = ::read(fd, chunk, sizeof(chunk));
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw Poco::ReadFileException(std::strerror(errno));
+        }
+        else if (result == 0)
+        {
+            break;
+        }
+
+        byteBuffer.writeBytes(chunk, static_cast<std::size_t>(result));
+        total += static_cast<std::size_t>(result);
+    }
+
+    return static_cast<std::streamsize>(total);
+#else
+    (void)fd;
+    (void)byteBuffer;
+    throw Poco::NotImplementedException("ByteBufferUtils::_loadFromFileDescriptor");
+#endif
+}
+
+
 bool ByteBufferUtils::saveToFile(const ByteBuffer& byteBuffer,
                                  const std::string& path,
                                  std::ios::openmode mode)
@@ -172,4 +500,292 @@ bool ByteBufferUtils::saveToFile(const ByteBuffer& byteBuffer,
 }
 
 
+bool ByteBufferUtils::writeToFile(const AbstractByteSource& source,
+                                  const std::string& path,
+                                  int options)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    std::string targetPath = path;
+    bool atomic = (options & SAVE_ATOMIC) != 0;
+
+    std::string directory = ".";
+    std::string::size_type slash = path.rfind('/');
+
+    if (slash != std::string::npos)
+    {
+        directory = slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+    int fd = -1;
+    bool created = false;
+    bool renamed = false;
+
+    if (atomic)
+    {
+        // Create a uniquely named temporary file next to the target so that
+        // the rename cannot cross file systems.
+        static std::atomic<unsigned> counter(0);
+
+        for (int attempt = 0; fd < 0 && attempt < 100; ++attempt)
+        {
+            std::ostringstream name;
+            name << (slash == std::string::npos ? "" : directory + "/")
+                 << "." << path.substr(slash == std::string::npos ? 0 : slash + 1)
+                 << ".tmp." << ::getpid() << "." << counter++;
+            targetPath = name.str();
+
+            fd = ::open(targetPath.c_str(),
+                        O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                        0666);
+
+            if (fd < 0 && errno != EEXIST && errno != EINTR)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        // Open an existing file first, so that a durable save knows whether
+        // it also has to sync a new directory entry.
+        for (;;)
+        {
+            fd = ::open(path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+
+            if (fd < 0 && errno == ENOENT)
+            {
+                fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+                created = fd >= 0;
+
+                if (fd < 0 && errno == EEXIST)
+                {
+                    // Created by someone else in the meantime.
+                    continue;
+                }
+            }
+
+            if (fd >= 0 || errno != EINTR)
+            {
+                break;
+            }
+        }
+    }
+
+    if (fd < 0)
+    {
+        throw Poco::CreateFileException(path, std::strerror(errno));
+    }
+
+    try
+    {
+        struct stat status;
+
+        // Keep the permissions of the file being replaced.
+        if (atomic && ::stat(path.c_str(), &status) == 0)
+        {
+            ::fchmod(fd, status.st_mode & 07777);
+        }
+
+        std::size_t size = source.size();
+
+#if defined(__linux__)
+        if ((options & SAVE_PREALLOCATE) && size > 0)
+        {
+            if (::fallocate(fd, 0, 0, static_cast<off_t>(size)) != 0 &&
+                errno != EOPNOTSUPP && errno != ENOSYS)
+            {
+                throw Poco::WriteFileException(path, std::strerror(errno));
+            }
+        }
+#endif
+
+        _writeToFileDescriptor(fd, source);
+
+        if ((options & SAVE_DURABLE) && ::fsync(fd) != 0)
+        {
+            throw Poco::WriteFileException(path, std::strerror(errno));
+        }
+
+        int result = ::close(fd);
+        fd = -1;
+
+        if (result != 0)
+        {
+            throw Poco::WriteFileException(path, std::strerror(errno));
+        }
+
+        if (atomic)
+        {
+            if (::rename(targetPath.c_str(), path.c_str()) != 0)
+            {
+                throw Poco::WriteFileException(path, std::strerror(errno));
+            }
+
+            renamed = true;
+        }
+
+        // Persist the directory entry created by the rename or the open.
+        if ((options & SAVE_DURABLE) && (renamed || created))
+        {
+            _syncDirectory(directory, path);
+        }
+    }
+    catch (...)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+
+        if (atomic && !renamed)
+        {
+            ::unlink(targetPath.c_str());
+        }
+
+        throw;
+    }
+
+    return true;
+#else
+    if (options & (SAVE_ATOMIC | SAVE_DURABLE))
+    {
+        throw Poco::NotImplementedException("ByteBufferUtils::writeToFile");
+    }
+
+    Poco::FileOutputStream fos(path, std::ios::out | std::ios::trunc);
+
+    if (fos.good())
+    {
+        copyBufferToStream(source, fos);
+        fos.close();
+        return true;
+    }
+    else
+    {
+        throw Poco::IOException("Bad file output stream.");
+    }
+#endif
+}
+
+
+std::size_t ByteBufferUtils::_writeToFileDescriptor(int fd,
+                                                    const AbstractByteSource& source)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+#if defined(IOV_MAX)
+    const std::size_t maxVectors = IOV_MAX;
+#else
+    const std::size_t maxVectors = 1024;
+#endif
+
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::vector<struct iovec> vectors;
+    std::vector<uint8_t> copy;
+
+    if (!source.getChunk(0, data, size))
+    {
+        // The source does not expose its bytes, so write a copy.
+        copy = source.readBytes();
+
+        if (!copy.empty())
+        {
+            struct iovec vector;
+            vector.iov_base = copy.data();
+            vector.iov_len = copy.size();
+            vectors.push_back(vector);
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; source.getChunk(i, data, size); ++i)
+        {
+            if (size == 0) continue;
+            struct iovec vector;
+            vector.iov_base = const_cast<uint8_t*>(data);
+            vector.iov_len = size;
+            vectors.push_back(vector);
+        }
+    }
+
+    std::size_t index = 0;
+    std::size_t total = 0;
+
+    while (index < vectors.size())
+    {
+        std::size_t count = std::min(maxVectors, vectors.size() - index);
+        ssize_t result = ::writev(fd, &vectors[index], static_cast<int>(count));
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw Poco::WriteFileException(std::strerror(errno));
+        }
+
+        std::size_t written = static_cast<std::size_t>(result);
+        total += written;
+
+        // Advance past the bytes that were written.
+        while (written > 0 && index < vectors.size())
+        {
+            if (written >= vectors[index].iov_len)
+            {
+                written -= vectors[index].iov_len;
+                ++index;
+            }
+            else
+            {
+                vectors[index].iov_base = static_cast<uint8_t*>(vectors[index].iov_base) + written;
+                vectors[index].iov_len -= written;
+                written = 0;
+            }
+        }
+    }
+
+    return total;
+#else
+    (void)fd;
+    (void)source;
+    throw Poco::NotImplementedException("ByteBufferUtils::_writeToFileDescriptor");
+#endif
+}
+
+
+void ByteBufferUtils::_syncDirectory(const std::string& directory,
+                                     const std::string& path)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    int fd = -1;
+
+    do
+    {
+        fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    while (fd < 0 && errno == EINTR);
+
+    if (fd < 0)
+    {
+        throw Poco::WriteFileException(path, std::strerror(errno));
+    }
+
+    if (::fsync(fd) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw Poco::WriteFileException(path, std::strerror(error));
+    }
+
+    ::close(fd);
+#else
+    (void)directory;
+    (void)path;
+    throw Poco::NotImplementedException("ByteBufferUtils::_syncDirectory");
+#endif
+}
+
+
 } } // ofx::IO
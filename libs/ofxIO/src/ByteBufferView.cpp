@@ -0,0 +1,164 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/ByteBufferView.h"
+#include <algorithm>
+#include "ofx/IO/ByteBuffer.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+ByteBufferView::ByteBufferView():
+    _data(nullptr),
+    _size(0)
+{
+}
+
+
+ByteBufferView::ByteBufferView(const uint8_t* buffer, std::size_t size):
+    _data(size > 0 ? buffer : nullptr),
+    _size(buffer != nullptr ? size : 0)
+{
+}
+
+
+ByteBufferView::ByteBufferView(const char* buffer, std::size_t size):
+    ByteBufferView(reinterpret_cast<const uint8_t*>(buffer), size)
+{
+}
+
+
+ByteBufferView::ByteBufferView(const ByteBuffer& buffer):
+    ByteBufferView(buffer.getPtr(), buffer.size())
+{
+}
+
+
+ByteBufferView::ByteBufferView(const ByteBuffer& buffer,
+                               std::size_t offset,
+                               std::size_t size):
+    ByteBufferView(ByteBufferView(buffer).subview(offset, size))
+{
+}
+
+
+ByteBufferView::~ByteBufferView()
+{
+}
+
+
+std::size_t ByteBufferView::readBytes(uint8_t* buffer, std::size_t size) const
+{
+    std::size_t numBytesToCopy = std::min(size, _size);
+    std::copy(_data, _data + numBytesToCopy, buffer);
+    return numBytesToCopy;
+}
+
+
+std::size_t ByteBufferView::readBytes(std::vector<uint8_t>& buffer) const
+{
+    buffer.assign(_data, _data + _size);
+    return buffer.size();
+}
+
+
+std::size_t ByteBufferView::readBytes(std::string& buffer) const
+{
+    buffer.assign(_data, _data + _size);
+    return buffer.size();
+}
+
+
+std::size_t ByteBufferView::readBytes(AbstractByteSink& buffer) const
+{
+    return buffer.writeBytes(_data, _size);
+}
+
+
+std::vector<uint8_t> ByteBufferView::readBytes() const
+{
+    return std::vector<uint8_t>(_data, _data + _size);
+}
+
+
+const uint8_t* ByteBufferView::getContiguousPtr() const
+{
+    return _data;
+}
+
+
+std::size_t ByteBufferView::size() const
+{
+    return _size;
+}
+
+
+bool ByteBufferView::empty() const
+{
+    return _size == 0;
+}
+
+
+uint8_t ByteBufferView::operator [] (std::size_t n) const
+{
+    return _data[n];
+}
+
+
+const uint8_t* ByteBufferView::getPtr() const
+{
+    return _data;
+}
+
+
+const char* ByteBufferView::getCharPtr() const
+{
+    return reinterpret_cast<const char*>(_data);
+}
+
+
+ByteBufferView ByteBufferView::subview(std::size_t offset,
+                                       std::size_t size) const
+{
+    if (offset >= _size)
+    {
+        return ByteBufferView();
+    }
+
+    return ByteBufferView(_data + offset, std::min(size, _size - offset));
+}
+
+
+std::string ByteBufferView::toString() const
+{
+    std::string s;
+    readBytes(s);
+    return s;
+}
+
+
+} }  // namespace ofx::IO
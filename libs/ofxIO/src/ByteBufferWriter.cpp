@@ -24,6 +24,7 @@
 
 
 #include "ofx/IO/ByteBufferWriter.h"
+#include <algorithm>
 #include <cstring>
 #include <string.h>
 
@@ -34,16 +35,66 @@ namespace IO {
 
 ByteBufferWriter::ByteBufferWriter(ByteBuffer& buffer, std::size_t offset):
     _buffer(buffer),
-    _offset(offset)
+    _offset(offset),
+    _policy(GROWTH_NONE),
+    _reserveStart(NO_RESERVATION)
 {
 }
 
 
+ByteBufferWriter::ByteBufferWriter(ByteBuffer& buffer,
+                                   std::size_t offset,
+                                   GrowthPolicy policy,
+                                   std::size_t reserveHint):
+    _buffer(buffer),
+    _offset(offset),
+    _policy(policy),
+    _reserveStart(NO_RESERVATION)
+{
+    if (_policy == GROWTH_GEOMETRIC && reserveHint > 0)
+    {
+        _buffer.reserve(_offset + reserveHint);
+    }
+}
+
+
+uint8_t* ByteBufferWriter::_prepare(std::size_t size)
+{
+    std::size_t end = _offset + size;
+    std::size_t oldSize = _buffer.size();
+
+    if (end > oldSize)
+    {
+        if (_policy != GROWTH_GEOMETRIC)
+        {
+            return nullptr;
+        }
+
+        if (end > _buffer.capacity())
+        {
+            _buffer.reserve(std::max(end, _buffer.capacity() * 2));
+        }
+
+        uint8_t* data = _buffer.resizeUninitialized(end);
+
+        // Never expose uninitialized bytes between the old end and offset.
+        if (_offset > oldSize)
+        {
+            std::memset(data + oldSize, 0, _offset - oldSize);
+        }
+    }
+
+    return _buffer.getPtr() + _offset;
+}
+
+
 std::size_t ByteBufferWriter::_write(const void* source, std::size_t size)
 {
-    if (_offset + size <= _buffer.size())
+    uint8_t* destination = _prepare(size);
+
+    if (destination != nullptr)
     {
-        std::memcpy(_buffer.getPtr() + _offset, source, size);
+        if (size > 0) std::memcpy(destination, source, size);
         _offset += size;
         return size;
     }
@@ -54,6 +105,87 @@ std::size_t ByteBufferWriter::_write(const void* source, std::size_t size)
 }
 
 
+std::size_t ByteBufferWriter::_writeOrdered(const void* source,
+                                            std::size_t count,
+                                            std::size_t width,
+                                            bool flip)
+{
+    std::size_t size = count * width;
+    uint8_t* destination = _prepare(size);
+
+    if (destination != nullptr)
+    {
+        if (!flip || width == 1)
+        {
+            if (size > 0) std::memcpy(destination, source, size);
+        }
+        else if (width == 2)
+        {
+            ByteOrder::flipBytes16(destination, source, count);
+        }
+        else if (width == 4)
+        {
+            ByteOrder::flipBytes32(destination, source, count);
+        }
+        else
+        {
+            ByteOrder::flipBytes64(destination, source, count);
+        }
+
+        _offset += size;
+        return size;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+
+uint8_t* ByteBufferWriter::reserveBytes(std::size_t size)
+{
+    _reserveStart = _buffer.size();
+    return _prepare(size);
+}
+
+
+std::size_t ByteBufferWriter::commitBytes(std::size_t size)
+{
+    if (_offset + size > _buffer.size())
+    {
+        return 0;
+    }
+
+    _offset += size;
+
+    // Trim reserved bytes that were not produced.
+    if (_reserveStart != NO_RESERVATION)
+    {
+        std::size_t end = std::max(_reserveStart, _offset);
+
+        if (end < _buffer.size())
+        {
+            _buffer.resize(end);
+        }
+    }
+
+    _reserveStart = NO_RESERVATION;
+    return size;
+}
+
+
+void ByteBufferWriter::setGrowthPolicy(GrowthPolicy policy)
+{
+    _policy = policy;
+}
+
+
+ByteBufferWriter::GrowthPolicy ByteBufferWriter::getGrowthPolicy() const
+{
+    return _policy;
+}
+
+
 void ByteBufferWriter::setOffset(size_t offset)
 {
     if (offset < _buffer.size()) _offset = offset;
@@ -0,0 +1,257 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/ByteOrder.h"
+
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief Flip the remaining values one at a time.
+template <typename UnsignedType>
+void flipScalar(uint8_t* destination,
+                const uint8_t* source,
+                std::size_t begin,
+                std::size_t count)
+{
+    for (std::size_t i = begin; i < count; ++i)
+    {
+        UnsignedType value;
+        std::memcpy(&value, source + i * sizeof(UnsignedType), sizeof(UnsignedType));
+        value = ByteOrder::flip(value);
+        std::memcpy(destination + i * sizeof(UnsignedType), &value, sizeof(UnsignedType));
+    }
+}
+
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+/// \brief Flip as many whole vectors as possible with a byte shuffle.
+/// \returns the number of values flipped.
+std::size_t flipShuffle(uint8_t* destination,
+                        const uint8_t* source,
+                        std::size_t count,
+                        std::size_t size,
+                        const int8_t* mask)
+{
+    std::size_t bytes = count * size;
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+
+    for (; i + 32 <= bytes; i += 32)
+    {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i),
+                            _mm256_shuffle_epi8(value, mask256));
+    }
+#endif
+
+    const __m128i mask128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i),
+                         _mm_shuffle_epi8(value, mask128));
+    }
+
+    return i / size;
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+/// \brief Swap the two bytes of each 16-bit lane.
+inline __m128i flipLanes16(__m128i value)
+{
+    return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+
+
+/// \brief Flip as many whole vectors as possible with SSE2, which every
+///        x86-64 target has.
+///
+/// The 16-bit words of each value are reversed with word shuffles, then the
+/// bytes of each word are swapped with shifts.
+///
+/// \returns the number of values flipped.
+template <std::size_t Size>
+std::size_t flipSSE2(uint8_t* destination,
+                     const uint8_t* source,
+                     std::size_t count)
+{
+    std::size_t bytes = count * Size;
+    std::size_t i = 0;
+
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+
+        if (Size == 4)
+        {
+            value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+            value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+        }
+        else if (Size == 8)
+        {
+            value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+            value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i),
+                         flipLanes16(value));
+    }
+
+    return i / Size;
+}
+#endif
+
+
+} // namespace
+
+
+void ByteOrder::flipBytes16(void* destination,
+                            const void* source,
+                            std::size_t count)
+{
+    uint8_t* d = static_cast<uint8_t*>(destination);
+    const uint8_t* s = static_cast<const uint8_t*>(source);
+    std::size_t i = 0;
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    static const int8_t mask[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+    i = flipShuffle(d, s, count, 2, mask);
+#elif defined(__SSE2__) || defined(_M_X64)
+    i = flipSSE2<2>(d, s, count);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u8(d + i * 2, vrev16q_u8(vld1q_u8(s + i * 2)));
+    }
+#endif
+
+    flipScalar<uint16_t>(d, s, i, count);
+}
+
+
+void ByteOrder::flipBytes32(void* destination,
+                            const void* source,
+                            std::size_t count)
+{
+    uint8_t* d = static_cast<uint8_t*>(destination);
+    const uint8_t* s = static_cast<const uint8_t*>(source);
+    std::size_t i = 0;
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    static const int8_t mask[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+    i = flipShuffle(d, s, count, 4, mask);
+#elif defined(__SSE2__) || defined(_M_X64)
+    i = flipSSE2<4>(d, s, count);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_u8(d + i * 4, vrev32q_u8(vld1q_u8(s + i * 4)));
+    }
+#endif
+
+    flipScalar<uint32_t>(d, s, i, count);
+}
+
+
+void ByteOrder::flipBytes64(void* destination,
+                            const void* source,
+                            std::size_t count)
+{
+    uint8_t* d = static_cast<uint8_t*>(destination);
+    const uint8_t* s = static_cast<const uint8_t*>(source);
+    std::size_t i = 0;
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    static const int8_t mask[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+    i = flipShuffle(d, s, count, 8, mask);
+#elif defined(__SSE2__) || defined(_M_X64)
+    i = flipSSE2<8>(d, s, count);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 2 <= count; i += 2)
+    {
+        vst1q_u8(d + i * 8, vrev64q_u8(vld1q_u8(s + i * 8)));
+    }
+#endif
+
+    flipScalar<uint64_t>(d, s, i, count);
+}
+
+
+void ByteOrder::_flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 1>)
+{
+    if (destination != source && count > 0)
+    {
+        std::memcpy(destination, source, count);
+    }
+}
+
+
+void ByteOrder::_flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 2>)
+{
+    flipBytes16(destination, source, count);
+}
+
+
+void ByteOrder::_flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 4>)
+{
+    flipBytes32(destination, source, count);
+}
+
+
+void ByteOrder::_flipBytes(void* destination,
+                           const void* source,
+                           std::size_t count,
+                           std::integral_constant<std::size_t, 8>)
+{
+    flipBytes64(destination, source, count);
+}
+
+
+} }  // namespace ofx::IO
@@ -0,0 +1,189 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/ByteRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "Poco/Exception.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+ByteRingBuffer::ByteRingBuffer(std::size_t capacity):
+    _writeIndex(0),
+    _cachedReadIndex(0),
+    _readIndex(0),
+    _cachedWriteIndex(0)
+{
+    // The largest power of two a std::size_t can hold.
+    const std::size_t maxCapacity = (std::numeric_limits<std::size_t>::max() >> 1) + 1;
+
+    if (capacity > maxCapacity)
+    {
+        throw Poco::InvalidArgumentException("ByteRingBuffer capacity is too large.");
+    }
+
+    std::size_t size = 1;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    _buffer.resize(size);
+    _mask = size - 1;
+}
+
+
+ByteRingBuffer::~ByteRingBuffer()
+{
+}
+
+
+std::size_t ByteRingBuffer::readByte(uint8_t& data)
+{
+    return readBytes(&data, 1);
+}
+
+
+std::size_t ByteRingBuffer::readBytes(uint8_t* buffer, std::size_t size)
+{
+    const std::size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+
+    if (_cachedWriteIndex - readIndex < size)
+    {
+        _cachedWriteIndex = _writeIndex.load(std::memory_order_acquire);
+    }
+
+    const std::size_t count = std::min(size, _cachedWriteIndex - readIndex);
+
+    if (count > 0)
+    {
+        const std::size_t offset = readIndex & _mask;
+        const std::size_t first = std::min(count, _buffer.size() - offset);
+        std::memcpy(buffer, _buffer.data() + offset, first);
+        std::memcpy(buffer + first, _buffer.data(), count - first);
+        _readIndex.store(readIndex + count, std::memory_order_release);
+    }
+
+    return count;
+}
+
+
+std::size_t ByteRingBuffer::available() const
+{
+    const std::size_t readIndex = _readIndex.load(std::memory_order_acquire);
+    return _writeIndex.load(std::memory_order_acquire) - readIndex;
+}
+
+
+std::size_t ByteRingBuffer::writeByte(uint8_t data)
+{
+    return writeBytes(&data, 1);
+}
+
+
+std::size_t ByteRingBuffer::writeBytes(const uint8_t* buffer, std::size_t size)
+{
+    const std::size_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+
+    if (_buffer.size() - (writeIndex - _cachedReadIndex) < size)
+    {
+        _cachedReadIndex = _readIndex.load(std::memory_order_acquire);
+    }
+
+    const std::size_t count = std::min(size,
+                                       _buffer.size() - (writeIndex - _cachedReadIndex));
+
+    if (count > 0)
+    {
+        const std::size_t offset = writeIndex & _mask;
+        const std::size_t first = std::min(count, _buffer.size() - offset);
+        std::memcpy(_buffer.data() + offset, buffer, first);
+        std::memcpy(_buffer.data(), buffer + first, count - first);
+        _writeIndex.store(writeIndex + count, std::memory_order_release);
+    }
+
+    return count;
+}
+
+
+std::size_t ByteRingBuffer::writeBytes(const std::vector<uint8_t>& buffer)
+{
+    return writeBytes(buffer.data(), buffer.size());
+}
+
+
+std::size_t ByteRingBuffer::writeBytes(const std::string& buffer)
+{
+    return writeBytes(reinterpret_cast<const uint8_t*>(buffer.data()),
+                      buffer.size());
+}
+
+
+std::size_t ByteRingBuffer::writeBytes(const AbstractByteSource& buffer)
+{
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+    if (!buffer.getChunk(0, data, size))
+    {
+        return writeBytes(buffer.readBytes());
+    }
+
+    std::size_t total = 0;
+    std::size_t index = 0;
+
+    while (buffer.getChunk(index++, data, size))
+    {
+        std::size_t written = writeBytes(data, size);
+        total += written;
+
+        if (written < size)
+        {
+            break;
+        }
+    }
+
+    return total;
+}
+
+
+std::size_t ByteRingBuffer::freeSpace() const
+{
+    return _buffer.size() - available();
+}
+
+
+std::size_t ByteRingBuffer::capacity() const
+{
+    return _buffer.size();
+}
+
+
+} }  // namespace ofx::IO
@@ -46,14 +46,27 @@ COBSEncoding::~COBSEncoding()
 
 std::size_t COBSEncoding::encode(const ByteBuffer& buffer,
                                  ByteBuffer& encodedBuffer)
+{
+    return encode(ByteBufferView(buffer), encodedBuffer);
+}
+
+
+std::size_t COBSEncoding::decode(const ByteBuffer& buffer,
+                                 ByteBuffer& decodedBuffer)
+{
+    return decode(ByteBufferView(buffer), decodedBuffer);
+}
+
+
+std::size_t COBSEncoding::encode(const ByteBufferView& buffer,
+                                 ByteBuffer& encodedBuffer)
 {
     if (buffer.size() > 0)
     {
         const std::size_t encodedMax = buffer.size() + (buffer.size() / 254) + 1;
-        encodedBuffer.resize(encodedMax);
         std::size_t size = encode(buffer.getPtr(),
                                   buffer.size(),
-                                  encodedBuffer.getPtr());
+                                  encodedBuffer.resizeUninitialized(encodedMax));
         encodedBuffer.resize(size);
         return encodedBuffer.size();
     }
@@ -64,15 +77,14 @@ std::size_t COBSEncoding::encode(const ByteBuffer& buffer,
 }
 
 
-std::size_t COBSEncoding::decode(const ByteBuffer& buffer,
+std::size_t COBSEncoding::decode(const ByteBufferView& buffer,
                                  ByteBuffer& decodedBuffer)
 {
     if (buffer.size() > 0)
     {
-        decodedBuffer.resize(buffer.size());
         std::size_t size = decode(buffer.getPtr(),
                                   buffer.size(),
-                                  decodedBuffer.getPtr());
+                                  decodedBuffer.resizeUninitialized(buffer.size()));
         decodedBuffer.resize(size);
         return decodedBuffer.size();
     }
@@ -83,6 +95,25 @@ std::size_t COBSEncoding::decode(const ByteBuffer& buffer,
 }
 
 
+std::size_t COBSEncoding::decode(ByteBuffer&& buffer,
+                                 ByteBuffer& decodedBuffer)
+{
+    if (buffer.size() > 0)
+    {
+        std::size_t size = decode(buffer.getPtr(),
+                                  buffer.size(),
+                                  buffer.getPtr());
+        buffer.resize(size);
+        decodedBuffer = std::move(buffer);
+        return decodedBuffer.size();
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+
 std::size_t COBSEncoding::encode(const uint8_t* buffer,
                                  std::size_t size,
                                  uint8_t* encoded)
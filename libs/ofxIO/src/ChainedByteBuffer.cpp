@@ -0,0 +1,472 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/ChainedByteBuffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "Poco/Exception.h"
+
+
+#if defined(POCO_OS_FAMILY_UNIX)
+#include <climits>
+#include <sys/uio.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+ChainedByteBuffer::ChainedByteBuffer(std::size_t segmentSize):
+    _segmentSize(std::max(segmentSize, std::size_t(1))),
+    _size(0)
+{
+}
+
+
+ChainedByteBuffer::ChainedByteBuffer(const ChainedByteBuffer& that):
+    AbstractByteSource(),
+    AbstractByteSink(),
+    _segmentSize(that._segmentSize),
+    _segments(that._segments),
+    _size(that._size)
+{
+}
+
+
+ChainedByteBuffer::ChainedByteBuffer(ChainedByteBuffer&& that):
+    AbstractByteSource(),
+    AbstractByteSink(),
+    _segmentSize(that._segmentSize),
+    _segments(std::move(that._segments)),
+    _tail(std::move(that._tail)),
+    _size(that._size)
+{
+    that._segments.clear();
+    that._tail = nullptr;
+    that._size = 0;
+}
+
+
+ChainedByteBuffer& ChainedByteBuffer::operator = (const ChainedByteBuffer& that)
+{
+    if (this != &that)
+    {
+        _segmentSize = that._segmentSize;
+        _segments = that._segments;
+        _tail = nullptr;
+        _size = that._size;
+    }
+
+    return *this;
+}
+
+
+ChainedByteBuffer& ChainedByteBuffer::operator = (ChainedByteBuffer&& that)
+{
+    if (this != &that)
+    {
+        _segmentSize = that._segmentSize;
+        _segments = std::move(that._segments);
+        _tail = std::move(that._tail);
+        _size = that._size;
+        that._segments.clear();
+        that._tail = nullptr;
+        that._size = 0;
+    }
+
+    return *this;
+}
+
+
+ChainedByteBuffer::~ChainedByteBuffer()
+{
+}
+
+
+std::size_t ChainedByteBuffer::readBytes(uint8_t* buffer, std::size_t size) const
+{
+    std::size_t total = 0;
+
+    for (const Segment& segment: _segments)
+    {
+        if (total == size)
+        {
+            break;
+        }
+
+        std::size_t numBytesToCopy = std::min(size - total, segment.size);
+        std::memcpy(buffer + total, segment.data(), numBytesToCopy);
+        total += numBytesToCopy;
+    }
+
+    return total;
+}
+
+
+std::size_t ChainedByteBuffer::readBytes(std::vector<uint8_t>& buffer) const
+{
+    buffer.resize(_size);
+    return readBytes(buffer.data(), buffer.size());
+}
+
+
+std::size_t ChainedByteBuffer::readBytes(std::string& buffer) const
+{
+    buffer.resize(_size);
+    return readBytes(reinterpret_cast<uint8_t*>(&buffer[0]), buffer.size());
+}
+
+
+std::size_t ChainedByteBuffer::readBytes(AbstractByteSink& buffer) const
+{
+    std::size_t total = 0;
+
+    for (const Segment& segment: _segments)
+    {
+        total += buffer.writeBytes(segment.data(), segment.size);
+    }
+
+    return total;
+}
+
+
+std::vector<uint8_t> ChainedByteBuffer::readBytes() const
+{
+    std::vector<uint8_t> buffer;
+    readBytes(buffer);
+    return buffer;
+}
+
+
+const uint8_t* ChainedByteBuffer::getContiguousPtr() const
+{
+    if (_segments.size() == 1)
+    {
+        return _segments.front().data();
+    }
+
+    return nullptr;
+}
+
+
+bool ChainedByteBuffer::getChunk(std::size_t index,
+                                 const uint8_t*& data,
+                                 std::size_t& size) const
+{
+    if (index < _segments.size())
+    {
+        data = _segments[index].data();
+        size = _segments[index].size;
+        return true;
+    }
+
+    return false;
+}
+
+
+std::size_t ChainedByteBuffer::writeByte(uint8_t data)
+{
+    return writeBytes(&data, 1);
+}
+
+
+std::size_t ChainedByteBuffer::writeBytes(const uint8_t* buffer, std::size_t size)
+{
+    std::size_t remaining = size;
+
+    while (remaining > 0)
+    {
+        if (_tail == nullptr || _tail->size() == _tail->capacity())
+        {
+            // Start a new segment rather than growing the tail, so that
+            // stored bytes are never moved.
+            _tail = std::make_shared<ByteBuffer>();
+            _tail->reserve(std::max(_segmentSize, remaining));
+            Segment segment = { _tail, 0, 0 };
+            _segments.push_back(segment);
+        }
+
+        std::size_t numBytesToCopy = std::min(remaining,
+                                              _tail->capacity() - _tail->size());
+        _tail->writeBytes(buffer, numBytesToCopy);
+        _segments.back().size += numBytesToCopy;
+        _size += numBytesToCopy;
+        buffer += numBytesToCopy;
+        remaining -= numBytesToCopy;
+    }
+
+    return size;
+}
+
+
+std::size_t ChainedByteBuffer::writeBytes(const std::vector<uint8_t>& buffer)
+{
+    return writeBytes(buffer.data(), buffer.size());
+}
+
+
+std::size_t ChainedByteBuffer::writeBytes(const std::string& buffer)
+{
+    return writeBytes(reinterpret_cast<const uint8_t*>(buffer.data()),
+                      buffer.size());
+}
+
+
+std::size_t ChainedByteBuffer::writeBytes(const AbstractByteSource& buffer)
+{
+    const ChainedByteBuffer* chain = dynamic_cast<const ChainedByteBuffer*>(&buffer);
+
+    if (chain != nullptr)
+    {
+        // Segments are immutable, so they can be shared instead of copied.
+        std::size_t size = chain->size();
+        append(*chain);
+        return size;
+    }
+
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+    if (!buffer.getChunk(0, data, size))
+    {
+        return writeBytes(buffer.readBytes());
+    }
+
+    std::size_t total = 0;
+    std::size_t index = 0;
+
+    while (buffer.getChunk(index++, data, size))
+    {
+        total += writeBytes(data, size);
+    }
+
+    return total;
+}
+
+
+void ChainedByteBuffer::append(SharedByteBuffer buffer)
+{
+    if (buffer != nullptr && !buffer->empty())
+    {
+        _segments.push_back(_makeSegment(buffer));
+        _size += buffer->size();
+        _tail.reset();
+    }
+}
+
+
+void ChainedByteBuffer::append(ByteBuffer&& buffer)
+{
+    append(std::make_shared<const ByteBuffer>(std::move(buffer)));
+}
+
+
+void ChainedByteBuffer::append(const ChainedByteBuffer& buffer)
+{
+    // Copy the segment list first in case buffer is this chain.
+    std::vector<Segment> segments(buffer._segments.begin(),
+                                  buffer._segments.end());
+
+    if (!segments.empty())
+    {
+        _segments.insert(_segments.end(), segments.begin(), segments.end());
+        _size += buffer._size;
+        _tail.reset();
+    }
+}
+
+
+void ChainedByteBuffer::prepend(SharedByteBuffer buffer)
+{
+    if (buffer != nullptr && !buffer->empty())
+    {
+        _segments.push_front(_makeSegment(buffer));
+        _size += buffer->size();
+    }
+}
+
+
+void ChainedByteBuffer::prepend(ByteBuffer&& buffer)
+{
+    prepend(std::make_shared<const ByteBuffer>(std::move(buffer)));
+}
+
+
+void ChainedByteBuffer::prepend(const ChainedByteBuffer& buffer)
+{
+    // Copy the segment list first in case buffer is this chain.
+    std::vector<Segment> segments(buffer._segments.begin(),
+                                  buffer._segments.end());
+
+    if (!segments.empty())
+    {
+        _segments.insert(_segments.begin(), segments.begin(), segments.end());
+        _size += buffer._size;
+
+        if (_segments.size() == segments.size())
+        {
+            // This chain was empty, so the tail is no longer our own.
+            _tail.reset();
+        }
+    }
+}
+
+
+std::size_t ChainedByteBuffer::size() const
+{
+    return _size;
+}
+
+
+std::size_t ChainedByteBuffer::getSegmentCount() const
+{
+    return _segments.size();
+}
+
+
+bool ChainedByteBuffer::empty() const
+{
+    return _size == 0;
+}
+
+
+void ChainedByteBuffer::clear()
+{
+    _segments.clear();
+    _tail.reset();
+    _size = 0;
+}
+
+
+void ChainedByteBuffer::coalesce()
+{
+    if (_segments.size() > 1)
+    {
+        std::shared_ptr<ByteBuffer> buffer = std::make_shared<ByteBuffer>();
+        buffer->reserve(_size);
+
+        for (const Segment& segment: _segments)
+        {
+            buffer->writeBytes(segment.data(), segment.size);
+        }
+
+        _segments.clear();
+        _segments.push_back(_makeSegment(buffer));
+        _tail = buffer;
+    }
+}
+
+
+const uint8_t* ChainedByteBuffer::getPtr()
+{
+    coalesce();
+    return getContiguousPtr();
+}
+
+
+std::size_t ChainedByteBuffer::writeTo(int fd) const
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+#if defined(IOV_MAX)
+    const std::size_t maxVectors = IOV_MAX;
+#else
+    const std::size_t maxVectors = 1024;
+#endif
+
+    std::vector<struct iovec> vectors;
+    std::size_t index = 0;
+    std::size_t offset = 0;
+    std::size_t total = 0;
+
+    while (index < _segments.size())
+    {
+        vectors.clear();
+
+        for (std::size_t i = index;
+             i < _segments.size() && vectors.size() < maxVectors;
+             ++i)
+        {
+            const Segment& segment = _segments[i];
+            std::size_t skip = (i == index) ? offset : 0;
+            struct iovec vector;
+            vector.iov_base = const_cast<uint8_t*>(segment.data() + skip);
+            vector.iov_len = segment.size - skip;
+            vectors.push_back(vector);
+        }
+
+        ssize_t result = ::writev(fd,
+                                  vectors.data(),
+                                  static_cast<int>(vectors.size()));
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw Poco::IOException("ChainedByteBuffer::writeTo", std::strerror(errno));
+        }
+
+        std::size_t written = static_cast<std::size_t>(result);
+        total += written;
+
+        // Advance past the bytes that were written.
+        while (written > 0 && index < _segments.size())
+        {
+            std::size_t available = _segments[index].size - offset;
+
+            if (written >= available)
+            {
+                written -= available;
+                offset = 0;
+                ++index;
+            }
+            else
+            {
+                offset += written;
+                written = 0;
+            }
+        }
+    }
+
+    return total;
+#else
+    (void)fd;
+    throw Poco::NotImplementedException("ChainedByteBuffer::writeTo");
+#endif
+}
+
+
+ChainedByteBuffer::Segment ChainedByteBuffer::_makeSegment(SharedByteBuffer buffer)
+{
+    Segment segment = { buffer, 0, buffer->size() };
+    return segment;
+}
+
+
+} }  // namespace ofx::IO
@@ -25,6 +25,7 @@
 
 #include "ofx/IO/Compression.h"
 #include "ofx/IO/ByteBufferStream.h"
+#include "ofx/IO/CompressionStream.h"
 #include "Poco/Buffer.h"
 #include "Poco/DeflatingStream.h"
 #include "Poco/InflatingStream.h"
@@ -41,6 +42,56 @@ namespace IO {
 std::size_t Compression::uncompress(const ByteBuffer& compressedBuffer,
                                     ByteBuffer& uncompressedBuffer,
                                     Type type)
+{
+    return uncompress(ByteBufferView(compressedBuffer), uncompressedBuffer, type);
+}
+
+
+std::size_t Compression::uncompress(const ByteBuffer& compressedBuffer,
+                                    ByteBuffer& uncompressedBuffer,
+                                    int windowBits)
+{
+    return uncompress(ByteBufferView(compressedBuffer),
+                      uncompressedBuffer,
+                      windowBits);
+}
+
+
+std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
+                                  ByteBuffer& compressedBuffer,
+                                  Type type)
+{
+    return compress(ByteBufferView(uncompressedBuffer), compressedBuffer, type);
+}
+
+
+std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
+                                  ByteBuffer& compressedBuffer,
+                                  Type type,
+                                  int level)
+{
+    return compress(ByteBufferView(uncompressedBuffer),
+                    compressedBuffer,
+                    type,
+                    level);
+}
+
+
+std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
+                                  ByteBuffer& compressedBuffer,
+                                  int windowBits,
+                                  int level)
+{
+    return compress(ByteBufferView(uncompressedBuffer),
+                    compressedBuffer,
+                    windowBits,
+                    level);
+}
+
+
+std::size_t Compression::uncompress(const ByteBufferView& compressedBuffer,
+                                    ByteBuffer& uncompressedBuffer,
+                                    Type type)
 {
     switch (type)
     {
@@ -81,41 +132,96 @@ std::size_t Compression::uncompress(const ByteBuffer& compressedBuffer,
                                               compressedBuffer.size(),
                                               &size))
             {
-                uncompressedBuffer.resize(size);
+                uint8_t* uncompressed = uncompressedBuffer.resizeUninitialized(size);
 
                 if (snappy::RawUncompress(compressedBuffer.getCharPtr(),
                                           compressedBuffer.size(),
-                                          uncompressedBuffer.getCharPtr()))
+                                          reinterpret_cast<char*>(uncompressed)))
                 {
                     return size;
                 }
                 else
                 {
+                    // Do not leave uninitialized bytes.
+                    uncompressedBuffer.clear();
                     return 0;
                 }
             }
             else
             {
+                uncompressedBuffer.clear();
                 return 0;
             }
         }
         case Type::LZ4:
         {
-            // TODO: Abritrary 4 x buffer.
-            uncompressedBuffer.resize(compressedBuffer.size() * 4);
+            // A raw LZ4 block does not record its uncompressed size, so grow
+            // the buffer from 4x until the block fits, up to the largest
+            // possible expansion or MAX_LZ4_UNCOMPRESSED_SIZE.
+            std::size_t initialCapacity = uncompressedBuffer.capacity();
+            std::size_t capacity = std::max<std::size_t>(compressedBuffer.size() * 4, 64);
+            std::size_t maxSize = std::min<std::size_t>(compressedBuffer.size() * 255 + 64,
+                                                        MAX_LZ4_UNCOMPRESSED_SIZE);
+            maxSize = std::min<std::size_t>(std::max(maxSize, capacity), LZ4_MAX_INPUT_SIZE);
+            capacity = std::min(capacity, maxSize);
+
+            for (;;)
+            {
+                uncompressedBuffer.resizeUninitialized(capacity);
 
-            int result = LZ4_decompress_safe(compressedBuffer.getCharPtr(),
-                                             uncompressedBuffer.getCharPtr(),
-                                             compressedBuffer.size(),
-                                             uncompressedBuffer.size());
+                int result = LZ4_decompress_safe(compressedBuffer.getCharPtr(),
+                                                 uncompressedBuffer.getCharPtr(),
+                                                 compressedBuffer.size(),
+                                                 uncompressedBuffer.size());
 
-            if (result >= 0)
+                if (result >= 0)
+                {
+                    uncompressedBuffer.resize(result);
+                    return result;
+                }
+                else if (capacity >= maxSize)
+                {
+                    break;
+                }
+
+                capacity = std::min(capacity * 2, maxSize);
+            }
+
+            // Do not leave uninitialized bytes, or memory grown for them.
+            if (uncompressedBuffer.capacity() > initialCapacity)
             {
-                uncompressedBuffer.resize(result);
-                return result;
+                ByteBuffer().swap(uncompressedBuffer);
             }
             else
             {
+                uncompressedBuffer.clear();
+            }
+
+            return 0;
+        }
+        case Type::LZ4_FRAME:
+        {
+            try
+            {
+                uncompressedBuffer.clear();
+
+                uint64_t contentSize = 0;
+
+                if (Decompressor::getLZ4FrameContentSize(compressedBuffer, contentSize))
+                {
+                    // Trust the recorded size only as far as LZ4 can expand.
+                    uncompressedBuffer.reserve(std::min<uint64_t>(contentSize,
+                                                                  uint64_t(compressedBuffer.size()) * 255));
+                }
+
+                Decompressor decompressor(type);
+                decompressor.update(compressedBuffer, uncompressedBuffer);
+                decompressor.finish();
+                return uncompressedBuffer.size();
+            }
+            catch (const Poco::Exception& exc)
+            {
+                ofLogError("Compression::uncompress") << exc.displayText();
                 return 0;
             }
         }
@@ -125,7 +231,7 @@ std::size_t Compression::uncompress(const ByteBuffer& compressedBuffer,
 }
 
 
-std::size_t Compression::uncompress(const ByteBuffer& compressedBuffer,
+std::size_t Compression::uncompress(const ByteBufferView& compressedBuffer,
                                     ByteBuffer& uncompressedBuffer,
                                     int windowBits)
 {
@@ -146,7 +252,7 @@ std::size_t Compression::uncompress(const ByteBuffer& compressedBuffer,
 }
 
 
-std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
+std::size_t Compression::compress(const ByteBufferView& uncompressedBuffer,
                                   ByteBuffer& compressedBuffer,
                                   Type type)
 {
@@ -163,11 +269,11 @@ std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
         case SNAPPY:
         {
             std::size_t size = 0;
-            // Allocate as many as needed.
-            compressedBuffer.resize(uncompressedBuffer.size());
+            // Allocate the worst case, without initializing it.
+            uint8_t* compressed = compressedBuffer.resizeUninitialized(snappy::MaxCompressedLength(uncompressedBuffer.size()));
             snappy::RawCompress(uncompressedBuffer.getCharPtr(),
                                 uncompressedBuffer.size(),
-                                compressedBuffer.getCharPtr(),
+                                reinterpret_cast<char*>(compressed),
                                 &size);
             compressedBuffer.resize(size);
             return size;
@@ -175,21 +281,46 @@ std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
         case LZ4:
         {
             std::size_t size = 0;
-            // Allocate as many as needed.
-            compressedBuffer.resize(uncompressedBuffer.size());
+            // Allocate the worst case, without initializing it.
+            uint8_t* compressed = compressedBuffer.resizeUninitialized(LZ4_compressBound(uncompressedBuffer.size()));
             size = LZ4_compress(uncompressedBuffer.getCharPtr(),
-                                compressedBuffer.getCharPtr(),
+                                reinterpret_cast<char*>(compressed),
                                 uncompressedBuffer.size());
             compressedBuffer.resize(size);
             return size;
         }
+        case LZ4_FRAME:
+        {
+            LZ4FrameOptions options;
+            options.hasContentSize = true;
+            options.contentSize = uncompressedBuffer.size();
+
+            // Use the smallest block size that holds the whole buffer.
+            while (options.blockSize > LZ4FrameOptions::BLOCK_SIZE_64KB &&
+                   uncompressedBuffer.size() <= (options.blockSizeBytes() >> 2))
+            {
+                options.blockSize = static_cast<LZ4FrameOptions::BlockSize>(options.blockSize - 1);
+            }
+
+            // Blocks that do not compress are stored, so the worst case is
+            // the input plus the framing.
+            compressedBuffer.clear();
+            compressedBuffer.reserve(uncompressedBuffer.size() +
+                                     (uncompressedBuffer.size() / options.blockSizeBytes() + 1) * 4 +
+                                     32);
+
+            Compressor compressor(options);
+            compressor.update(uncompressedBuffer, compressedBuffer);
+            compressor.finish(compressedBuffer);
+            return compressedBuffer.size();
+        }
     }
 
     return 0;
 }
 
 
-std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
+std::size_t Compression::compress(const ByteBufferView& uncompressedBuffer,
                                   ByteBuffer& compressedBuffer,
                                   Type type,
                                   int level)
@@ -219,6 +350,7 @@ std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
         Poco::DeflatingOutputStream deflater(ostr, streamType, level);
         deflater << uncompressedBuffer;
         deflater.close();
+        ostr.flush();
 
         return compressedBuffer.size();
     }
@@ -230,7 +362,7 @@ std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
 }
 
 
-std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
+std::size_t Compression::compress(const ByteBufferView& uncompressedBuffer,
                                   ByteBuffer& compressedBuffer,
                                   int windowBits,
                                   int level)
@@ -243,6 +375,7 @@ std::size_t Compression::compress(const ByteBuffer& uncompressedBuffer,
         Poco::DeflatingOutputStream deflater(ostr, windowBits, level);
         deflater << uncompressedBuffer;
         deflater.close();
+        ostr.flush();
         return compressedBuffer.size();
     }
     catch (const Poco::Exception& exc)
@@ -271,6 +404,7 @@ std::string Compression::version(Type type)
             return ss.str();
         }
         case LZ4:
+        case LZ4_FRAME:
         {
             std::stringstream ss;
             ss << LZ4_VERSION_MAJOR << "." << LZ4_VERSION_MINOR << "." << LZ4_VERSION_RELEASE;
@@ -293,6 +427,8 @@ std::string Compression::toString(Type type)
             return "SNAPPY";
         case LZ4:
             return "LZ4";
+        case LZ4_FRAME:
+            return "LZ4_FRAME";
     }
 
     return "UNKNOWN";
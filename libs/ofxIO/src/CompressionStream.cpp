@@ -0,0 +1,1467 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/CompressionStream.h"
+#include <algorithm>
+#include <cstring>
+#include "Poco/Exception.h"
+#include "ofx/IO/ByteOrder.h"
+#include "snappy.h"
+#include "lz4.h"
+
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief The Snappy framing format stream identifier chunk.
+const uint8_t SNAPPY_STREAM_IDENTIFIER[] = {
+    0xff, 0x06, 0x00, 0x00, 's', 'N', 'a', 'P', 'p', 'Y'
+};
+
+/// \brief The magic number of an LZ4 legacy frame.
+const uint32_t LZ4_LEGACY_MAGIC = 0x184C2102;
+
+/// \brief The magic number of an LZ4 frame.
+const uint32_t LZ4_FRAME_MAGIC = 0x184D2204;
+
+/// \brief The magic number of a skippable frame, ignoring the low 4 bits.
+const uint32_t LZ4_SKIPPABLE_MAGIC = 0x184D2A50;
+
+/// \brief The amount of history that linked LZ4 blocks may refer to.
+const std::size_t LZ4_HISTORY_SIZE = 64 * 1024;
+
+/// \brief The high bit of an LZ4 block size marks an uncompressed block.
+const uint32_t LZ4_UNCOMPRESSED_BLOCK = 0x80000000;
+
+/// \brief LZ4 frame descriptor flags.
+enum
+{
+    LZ4_FLAG_VERSION = 0x40,
+    LZ4_FLAG_VERSION_MASK = 0xC0,
+    LZ4_FLAG_BLOCK_INDEPENDENCE = 0x20,
+    LZ4_FLAG_BLOCK_CHECKSUM = 0x10,
+    LZ4_FLAG_CONTENT_SIZE = 0x08,
+    LZ4_FLAG_CONTENT_CHECKSUM = 0x04,
+    LZ4_FLAG_RESERVED = 0x02,
+    LZ4_FLAG_DICTIONARY_ID = 0x01
+};
+
+
+uint32_t loadLittleEndian32(const uint8_t* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return ByteOrder::fromLittleEndian(value);
+}
+
+
+void storeLittleEndian32(uint8_t* data, uint32_t value)
+{
+    value = ByteOrder::toLittleEndian(value);
+    std::memcpy(data, &value, sizeof(value));
+}
+
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+/// \brief Slicing-by-8 tables for the CRC-32C (Castagnoli) polynomial.
+struct CRC32CTables
+{
+    CRC32CTables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+
+            for (int j = 0; j < 8; ++j)
+            {
+                crc = (crc >> 1) ^ (0x82F63B78 & (0u - (crc & 1)));
+            }
+
+            table[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (int j = 1; j < 8; ++j)
+            {
+                table[j][i] = (table[j - 1][i] >> 8) ^ table[0][table[j - 1][i] & 0xff];
+            }
+        }
+    }
+
+    uint32_t table[8][256];
+};
+#endif
+
+
+/// \brief Calculate the CRC-32C of a block of bytes.
+uint32_t crc32c(const uint8_t* data, std::size_t size)
+{
+    uint32_t crc = 0xffffffff;
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    while (size >= 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+#if defined(__SSE4_2__)
+        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+#else
+        crc = __crc32cd(crc, value);
+#endif
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+    {
+#if defined(__SSE4_2__)
+        crc = _mm_crc32_u8(crc, *data++);
+#else
+        crc = __crc32cb(crc, *data++);
+#endif
+    }
+#else
+    static const CRC32CTables tables;
+    const uint32_t (&t)[8][256] = tables.table;
+
+    while (size >= 8)
+    {
+        uint32_t low = loadLittleEndian32(data) ^ crc;
+        uint32_t high = loadLittleEndian32(data + 4);
+        crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+              t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+              t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^
+              t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xff];
+    }
+#endif
+
+    return ~crc;
+}
+
+
+/// \brief An incremental xxHash32, as used by the LZ4 frame format.
+class XXHash32
+{
+public:
+    XXHash32()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        _v[0] = PRIME1 + PRIME2;
+        _v[1] = PRIME2;
+        _v[2] = 0;
+        _v[3] = 0u - PRIME1;
+        _total = 0;
+        _bufferSize = 0;
+    }
+
+    void update(const uint8_t* data, std::size_t size)
+    {
+        _total += size;
+
+        if (_bufferSize + size < 16)
+        {
+            std::memcpy(_buffer + _bufferSize, data, size);
+            _bufferSize += size;
+            return;
+        }
+
+        if (_bufferSize > 0)
+        {
+            std::size_t count = 16 - _bufferSize;
+            std::memcpy(_buffer + _bufferSize, data, count);
+            _stripe(_buffer);
+            data += count;
+            size -= count;
+            _bufferSize = 0;
+        }
+
+        while (size >= 16)
+        {
+            _stripe(data);
+            data += 16;
+            size -= 16;
+        }
+
+        std::memcpy(_buffer, data, size);
+        _bufferSize = size;
+    }
+
+    uint32_t digest() const
+    {
+        uint32_t hash = 0;
+
+        if (_total >= 16)
+        {
+            hash = _rotate(_v[0], 1) + _rotate(_v[1], 7) +
+                   _rotate(_v[2], 12) + _rotate(_v[3], 18);
+        }
+        else
+        {
+            hash = PRIME5;
+        }
+
+        hash += static_cast<uint32_t>(_total);
+
+        const uint8_t* data = _buffer;
+        std::size_t size = _bufferSize;
+
+        while (size >= 4)
+        {
+            hash = _rotate(hash + loadLittleEndian32(data) * PRIME3, 17) * PRIME4;
+            data += 4;
+            size -= 4;
+        }
+
+        while (size-- > 0)
+        {
+            hash = _rotate(hash + *data++ * PRIME5, 11) * PRIME1;
+        }
+
+        hash ^= hash >> 15;
+        hash *= PRIME2;
+        hash ^= hash >> 13;
+        hash *= PRIME3;
+        hash ^= hash >> 16;
+
+        return hash;
+    }
+
+    static uint32_t hash(const uint8_t* data, std::size_t size)
+    {
+        XXHash32 state;
+        state.update(data, size);
+        return state.digest();
+    }
+
+private:
+    static const uint32_t PRIME1 = 2654435761u;
+    static const uint32_t PRIME2 = 2246822519u;
+    static const uint32_t PRIME3 = 3266489917u;
+    static const uint32_t PRIME4 = 668265263u;
+    static const uint32_t PRIME5 = 374761393u;
+
+    static uint32_t _rotate(uint32_t value, int bits)
+    {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    void _stripe(const uint8_t* data)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            _v[i] = _rotate(_v[i] + loadLittleEndian32(data + 4 * i) * PRIME2, 13) * PRIME1;
+        }
+    }
+
+    uint32_t _v[4];
+    uint64_t _total;
+    uint8_t _buffer[16];
+    std::size_t _bufferSize;
+};
+
+
+/// \brief Calculate the masked CRC-32C used by the Snappy framing format.
+uint32_t snappyChecksum(const uint8_t* data, std::size_t size)
+{
+    uint32_t crc = crc32c(data, size);
+    return ((crc >> 15) | (crc << 17)) + 0xa282ead8;
+}
+
+
+} // namespace
+
+
+struct Compressor::LZ4FrameEncoder
+{
+    LZ4FrameEncoder(const LZ4FrameOptions& options_):
+        options(options_),
+        stream(nullptr),
+        blockStart(0),
+        blockFill(0),
+        contentSize(0)
+    {
+    }
+
+    ~LZ4FrameEncoder()
+    {
+        reset();
+    }
+
+    /// \brief Prepare for a new frame.
+    void reset()
+    {
+        if (stream)
+        {
+            LZ4_free(stream);
+            stream = nullptr;
+        }
+
+        blockStart = 0;
+        blockFill = 0;
+        contentSize = 0;
+        contentHash.reset();
+    }
+
+    /// \brief The frame options.
+    LZ4FrameOptions options;
+
+    /// \brief The LZ4 stream state for linked blocks.
+    void* stream;
+
+    /// \brief The history and current block for linked blocks.
+    ByteBuffer window;
+
+    /// \brief The offset of the current block in the window.
+    std::size_t blockStart;
+
+    /// \brief The number of bytes in the current block.
+    std::size_t blockFill;
+
+    /// \brief The number of bytes compressed in this frame.
+    uint64_t contentSize;
+
+    /// \brief The checksum of the bytes compressed in this frame.
+    XXHash32 contentHash;
+};
+
+
+struct Decompressor::LZ4FrameDecoder
+{
+    LZ4FrameDecoder():
+        flags(0),
+        blockMaxSize(0),
+        contentSize(0),
+        decompressedSize(0),
+        skipRemaining(0),
+        framesRead(0)
+    {
+    }
+
+    /// \brief The descriptor flags of the current frame.
+    uint8_t flags;
+
+    /// \brief The maximum uncompressed size of a block.
+    std::size_t blockMaxSize;
+
+    /// \brief The content size recorded in the frame header, if any.
+    uint64_t contentSize;
+
+    /// \brief The number of bytes decompressed in this frame.
+    uint64_t decompressedSize;
+
+    /// \brief The number of bytes of a skippable frame left to skip.
+    uint64_t skipRemaining;
+
+    /// \brief The number of complete frames read.
+    std::size_t framesRead;
+
+    /// \brief The checksum of the bytes decompressed in this frame.
+    XXHash32 contentHash;
+
+    /// \brief The history and current block for linked blocks.
+    ByteBuffer window;
+};
+
+
+LZ4FrameOptions::LZ4FrameOptions():
+    blockSize(BLOCK_SIZE_4MB),
+    linkedBlocks(false),
+    blockChecksums(false),
+    contentChecksum(true),
+    hasContentSize(false),
+    contentSize(0)
+{
+}
+
+
+std::size_t LZ4FrameOptions::blockSizeBytes() const
+{
+    if (blockSize < BLOCK_SIZE_64KB || blockSize > BLOCK_SIZE_4MB)
+    {
+        throw Poco::InvalidArgumentException("Invalid LZ4 frame block size.");
+    }
+
+    return std::size_t(1) << (8 + 2 * blockSize);
+}
+
+
+Compressor::Compressor(Compression::Type type):
+    _type(type),
+    _blockSize(0),
+    _headerWritten(false)
+{
+    switch (type)
+    {
+        case Compression::SNAPPY:
+            _blockSize = SNAPPY_BLOCK_SIZE;
+            break;
+        case Compression::LZ4:
+            _blockSize = LZ4_LEGACY_BLOCK_SIZE;
+            break;
+        case Compression::LZ4_FRAME:
+            _frame.reset(new LZ4FrameEncoder(LZ4FrameOptions()));
+            _blockSize = _frame->options.blockSizeBytes();
+            break;
+        default:
+            throw Poco::InvalidArgumentException("Compressor does not support " + Compression::toString(type));
+    }
+}
+
+
+Compressor::Compressor(const LZ4FrameOptions& options):
+    _type(Compression::LZ4_FRAME),
+    _blockSize(options.blockSizeBytes()),
+    _headerWritten(false),
+    _frame(new LZ4FrameEncoder(options))
+{
+}
+
+
+Compressor::~Compressor()
+{
+}
+
+
+std::size_t Compressor::update(const ByteBufferView& input, ByteBuffer& output)
+{
+    std::size_t start = output.size();
+    const uint8_t* data = input.getPtr();
+    std::size_t size = input.size();
+
+    _writeHeader(output);
+
+    if (_frame && _frame->options.linkedBlocks)
+    {
+        // Linked blocks must be laid out one after another in the window
+        // that the LZ4 stream state refers to.
+        LZ4FrameEncoder& frame = *_frame;
+
+        while (size > 0)
+        {
+            if (frame.blockFill == 0 && frame.blockStart + _blockSize > frame.window.size())
+            {
+                char* next = LZ4_slideInputBuffer(frame.stream);
+                frame.blockStart = static_cast<std::size_t>(next - frame.window.getCharPtr());
+            }
+
+            std::size_t count = std::min(size, _blockSize - frame.blockFill);
+            std::memcpy(frame.window.getPtr() + frame.blockStart + frame.blockFill, data, count);
+            frame.blockFill += count;
+            data += count;
+            size -= count;
+
+            if (frame.blockFill == _blockSize)
+            {
+                _compressBlock(frame.window.getPtr() + frame.blockStart, _blockSize, output);
+                frame.blockStart += _blockSize;
+                frame.blockFill = 0;
+            }
+        }
+
+        return output.size() - start;
+    }
+
+    if (!_pending.empty())
+    {
+        std::size_t count = std::min(size, _blockSize - _pending.size());
+        _pending.writeBytes(data, count);
+        data += count;
+        size -= count;
+
+        if (_pending.size() == _blockSize)
+        {
+            _compressBlock(_pending.getPtr(), _pending.size(), output);
+            _pending.clear();
+        }
+    }
+
+    // Compress whole blocks directly from the input.
+    while (size >= _blockSize)
+    {
+        _compressBlock(data, _blockSize, output);
+        data += _blockSize;
+        size -= _blockSize;
+    }
+
+    if (size > 0)
+    {
+        _pending.writeBytes(data, size);
+    }
+
+    return output.size() - start;
+}
+
+
+std::size_t Compressor::flush(ByteBuffer& output)
+{
+    std::size_t start = output.size();
+
+    _writeHeader(output);
+
+    if (_frame && _frame->options.linkedBlocks)
+    {
+        LZ4FrameEncoder& frame = *_frame;
+
+        if (frame.blockFill > 0)
+        {
+            _compressBlock(frame.window.getPtr() + frame.blockStart, frame.blockFill, output);
+            frame.blockStart += frame.blockFill;
+            frame.blockFill = 0;
+        }
+    }
+    else if (!_pending.empty())
+    {
+        _compressBlock(_pending.getPtr(), _pending.size(), output);
+        _pending.clear();
+    }
+
+    return output.size() - start;
+}
+
+
+std::size_t Compressor::finish(ByteBuffer& output)
+{
+    std::size_t start = output.size();
+
+    flush(output);
+
+    if (_frame)
+    {
+        LZ4FrameEncoder& frame = *_frame;
+
+        // The end mark, followed by the content checksum.
+        storeLittleEndian32(output.appendUninitialized(4), 0);
+
+        if (frame.options.contentChecksum)
+        {
+            storeLittleEndian32(output.appendUninitialized(4), frame.contentHash.digest());
+        }
+
+        bool sizeMismatch = frame.options.hasContentSize &&
+                            frame.options.contentSize != frame.contentSize;
+
+        frame.reset();
+
+        if (sizeMismatch)
+        {
+            _headerWritten = false;
+            throw Poco::IllegalStateException("LZ4 frame content size does not match the compressed data.");
+        }
+    }
+
+    _headerWritten = false;
+
+    return output.size() - start;
+}
+
+
+Compression::Type Compressor::type() const
+{
+    return _type;
+}
+
+
+std::size_t Compressor::blockSize() const
+{
+    return _blockSize;
+}
+
+
+void Compressor::_writeHeader(ByteBuffer& output)
+{
+    if (_headerWritten)
+    {
+        return;
+    }
+
+    if (_type == Compression::SNAPPY)
+    {
+        output.writeBytes(SNAPPY_STREAM_IDENTIFIER, sizeof(SNAPPY_STREAM_IDENTIFIER));
+    }
+    else if (_type == Compression::LZ4)
+    {
+        storeLittleEndian32(output.appendUninitialized(4), LZ4_LEGACY_MAGIC);
+    }
+    else
+    {
+        LZ4FrameEncoder& frame = *_frame;
+        const LZ4FrameOptions& options = frame.options;
+
+        // Magic number, flags, block descriptor, optional content size and
+        // header checksum.
+        uint8_t header[19];
+        std::size_t size = 6;
+
+        storeLittleEndian32(header, LZ4_FRAME_MAGIC);
+        header[4] = LZ4_FLAG_VERSION;
+        header[4] |= options.linkedBlocks ? 0 : LZ4_FLAG_BLOCK_INDEPENDENCE;
+        header[4] |= options.blockChecksums ? LZ4_FLAG_BLOCK_CHECKSUM : 0;
+        header[4] |= options.hasContentSize ? LZ4_FLAG_CONTENT_SIZE : 0;
+        header[4] |= options.contentChecksum ? LZ4_FLAG_CONTENT_CHECKSUM : 0;
+        header[5] = static_cast<uint8_t>(options.blockSize << 4);
+
+        if (options.hasContentSize)
+        {
+            uint64_t contentSize = ByteOrder::toLittleEndian(options.contentSize);
+            std::memcpy(header + size, &contentSize, sizeof(contentSize));
+            size += sizeof(contentSize);
+        }
+
+        header[size] = static_cast<uint8_t>(XXHash32::hash(header + 4, size - 4) >> 8);
+        output.writeBytes(header, size + 1);
+
+        if (options.linkedBlocks)
+        {
+            // Room for two histories and a block, so that a block only
+            // needs a slide once it starts past 128 KiB, and the 64 KiB of
+            // history that LZ4_slideInputBuffer copies to the start of the
+            // window never overlaps its destination.
+            frame.window.resizeUninitialized(2 * LZ4_HISTORY_SIZE + _blockSize);
+            frame.stream = LZ4_create(frame.window.getCharPtr());
+
+            if (!frame.stream)
+            {
+                throw Poco::OutOfMemoryException("Unable to create LZ4 stream.");
+            }
+        }
+    }
+
+    _headerWritten = true;
+}
+
+
+void Compressor::_compressBlock(const uint8_t* data,
+                                std::size_t size,
+                                ByteBuffer& output)
+{
+    std::size_t start = output.size();
+
+    if (_type == Compression::SNAPPY)
+    {
+        // Chunk type, 24-bit length and checksum, followed by the data.
+        uint8_t* chunk = output.appendUninitialized(8 + snappy::MaxCompressedLength(size));
+        std::size_t compressedSize = 0;
+
+        snappy::RawCompress(reinterpret_cast<const char*>(data),
+                            size,
+                            reinterpret_cast<char*>(chunk + 8),
+                            &compressedSize);
+
+        uint8_t chunkType = 0x00;
+
+        // Store the data uncompressed if compression saves less than 12.5%.
+        if (compressedSize >= size - size / 8)
+        {
+            chunkType = 0x01;
+            std::memcpy(chunk + 8, data, size);
+            compressedSize = size;
+        }
+
+        std::size_t length = compressedSize + 4;
+        chunk[0] = chunkType;
+        chunk[1] = static_cast<uint8_t>(length);
+        chunk[2] = static_cast<uint8_t>(length >> 8);
+        chunk[3] = static_cast<uint8_t>(length >> 16);
+        storeLittleEndian32(chunk + 4, snappyChecksum(data, size));
+
+        output.resize(start + 8 + compressedSize);
+    }
+    else if (_frame)
+    {
+        LZ4FrameEncoder& frame = *_frame;
+        const LZ4FrameOptions& options = frame.options;
+        std::size_t checksumSize = options.blockChecksums ? 4 : 0;
+
+        // A 32-bit block size, the block and an optional checksum.  Blocks
+        // that do not compress are stored as they are.
+        uint8_t* block = output.appendUninitialized(4 + size + checksumSize);
+        int inputSize = static_cast<int>(size);
+        int compressedSize = 0;
+
+        if (options.linkedBlocks)
+        {
+            // Always called, so the stream state moves past this block.
+            compressedSize = LZ4_compress_limitedOutput_continue(frame.stream,
+                                                                 reinterpret_cast<const char*>(data),
+                                                                 reinterpret_cast<char*>(block + 4),
+                                                                 inputSize,
+                                                                 inputSize - 1);
+        }
+        else if (inputSize > 1)
+        {
+            compressedSize = LZ4_compress_limitedOutput(reinterpret_cast<const char*>(data),
+                                                        reinterpret_cast<char*>(block + 4),
+                                                        inputSize,
+                                                        inputSize - 1);
+        }
+
+        if (compressedSize > 0)
+        {
+            storeLittleEndian32(block, static_cast<uint32_t>(compressedSize));
+        }
+        else
+        {
+            std::memcpy(block + 4, data, size);
+            compressedSize = inputSize;
+            storeLittleEndian32(block, static_cast<uint32_t>(size) | LZ4_UNCOMPRESSED_BLOCK);
+        }
+
+        if (options.blockChecksums)
+        {
+            storeLittleEndian32(block + 4 + compressedSize,
+                                XXHash32::hash(block + 4, static_cast<std::size_t>(compressedSize)));
+        }
+
+        if (options.contentChecksum)
+        {
+            frame.contentHash.update(data, size);
+        }
+
+        frame.contentSize += size;
+        output.resize(start + 4 + static_cast<std::size_t>(compressedSize) + checksumSize);
+    }
+    else
+    {
+        // A 32-bit compressed size, followed by the compressed block.
+        uint8_t* block = output.appendUninitialized(4 + LZ4_compressBound(static_cast<int>(size)));
+
+        int compressedSize = LZ4_compress(reinterpret_cast<const char*>(data),
+                                          reinterpret_cast<char*>(block + 4),
+                                          static_cast<int>(size));
+
+        storeLittleEndian32(block, static_cast<uint32_t>(compressedSize));
+        output.resize(start + 4 + static_cast<std::size_t>(compressedSize));
+    }
+}
+
+
+Decompressor::Decompressor(Compression::Type type):
+    _type(type),
+    _headerRead(false)
+{
+    if (type == Compression::LZ4_FRAME)
+    {
+        _frame.reset(new LZ4FrameDecoder());
+    }
+    else if (type != Compression::SNAPPY && type != Compression::LZ4)
+    {
+        throw Poco::InvalidArgumentException("Decompressor does not support " + Compression::toString(type));
+    }
+}
+
+
+Decompressor::~Decompressor()
+{
+}
+
+
+std::size_t Decompressor::update(const ByteBufferView& input, ByteBuffer& output)
+{
+    std::size_t start = output.size();
+
+    if (_pending.empty())
+    {
+        // Decompress directly from the input and keep any partial block.
+        std::size_t consumed = _decompressBlocks(input.getPtr(), input.size(), output);
+        _pending.writeBytes(input.getPtr() + consumed, input.size() - consumed);
+    }
+    else
+    {
+        _pending.writeBytes(input.getPtr(), input.size());
+
+        std::size_t consumed = _decompressBlocks(_pending.getPtr(), _pending.size(), output);
+
+        if (consumed > 0)
+        {
+            std::size_t remaining = _pending.size() - consumed;
+            std::memmove(_pending.getPtr(), _pending.getPtr() + consumed, remaining);
+            _pending.resize(remaining);
+        }
+    }
+
+    return output.size() - start;
+}
+
+
+void Decompressor::finish()
+{
+    // An LZ4 frame stream must end after a complete frame, while the other
+    // formats may end after any complete block.
+    bool complete = _frame ? (_frame->framesRead > 0 && !_headerRead && _frame->skipRemaining == 0)
+                           : _headerRead;
+
+    _headerRead = false;
+
+    if (_frame)
+    {
+        _frame->framesRead = 0;
+        _frame->skipRemaining = 0;
+    }
+
+    if (!complete || !_pending.empty())
+    {
+        _pending.clear();
+        throw Poco::DataFormatException("Truncated " + Compression::toString(_type) + " stream.");
+    }
+}
+
+
+Compression::Type Decompressor::type() const
+{
+    return _type;
+}
+
+
+bool Decompressor::getLZ4FrameContentSize(const ByteBufferView& buffer,
+                                          uint64_t& contentSize)
+{
+    const uint8_t* data = buffer.getPtr();
+
+    if (buffer.size() < 15 ||
+        loadLittleEndian32(data) != LZ4_FRAME_MAGIC ||
+        !(data[4] & LZ4_FLAG_CONTENT_SIZE))
+    {
+        return false;
+    }
+
+    std::memcpy(&contentSize, data + 6, sizeof(contentSize));
+    contentSize = ByteOrder::fromLittleEndian(contentSize);
+    return true;
+}
+
+
+std::size_t Decompressor::_decompressBlocks(const uint8_t* data,
+                                            std::size_t size,
+                                            ByteBuffer& output)
+{
+    if (_frame)
+    {
+        return _decompressLZ4Frames(data, size, output);
+    }
+
+    std::size_t offset = 0;
+
+    if (_type == Compression::SNAPPY)
+    {
+        while (size - offset >= 4)
+        {
+            const uint8_t* chunk = data + offset;
+            uint8_t chunkType = chunk[0];
+            std::size_t length = chunk[1] | (chunk[2] << 8) | (chunk[3] << 16);
+
+            // Reject bad chunks before waiting for the rest of their data.
+            if (!_headerRead && chunkType != 0xff)
+            {
+                throw Poco::DataFormatException("Missing Snappy stream identifier.");
+            }
+            else if (chunkType >= 0x02 && chunkType < 0x80)
+            {
+                throw Poco::DataFormatException("Unsupported unskippable Snappy chunk.");
+            }
+            else if (chunkType < 0x02 &&
+                     length > 4 + snappy::MaxCompressedLength(Compressor::SNAPPY_BLOCK_SIZE))
+            {
+                throw Poco::DataFormatException("Snappy chunk is too large.");
+            }
+
+            if (size - offset - 4 < length)
+            {
+                break;
+            }
+
+            const uint8_t* body = chunk + 4;
+
+            if (chunkType == 0xff)
+            {
+                if (length != 6 || std::memcmp(body, SNAPPY_STREAM_IDENTIFIER + 4, 6) != 0)
+                {
+                    throw Poco::DataFormatException("Invalid Snappy stream identifier.");
+                }
+
+                _headerRead = true;
+            }
+            else if (chunkType == 0x00 || chunkType == 0x01)
+            {
+                if (length < 4)
+                {
+                    throw Poco::DataFormatException("Invalid Snappy chunk length.");
+                }
+
+                const char* payload = reinterpret_cast<const char*>(body + 4);
+                std::size_t payloadSize = length - 4;
+                std::size_t uncompressedSize = payloadSize;
+
+                if (chunkType == 0x00 &&
+                    !snappy::GetUncompressedLength(payload, payloadSize, &uncompressedSize))
+                {
+                    throw Poco::DataFormatException("Invalid Snappy chunk.");
+                }
+
+                if (uncompressedSize > Compressor::SNAPPY_BLOCK_SIZE)
+                {
+                    throw Poco::DataFormatException("Snappy chunk is too large.");
+                }
+
+                std::size_t start = output.size();
+                uint8_t* uncompressed = output.appendUninitialized(uncompressedSize);
+
+                if (chunkType == 0x00)
+                {
+                    if (!snappy::RawUncompress(payload,
+                                               payloadSize,
+                                               reinterpret_cast<char*>(uncompressed)))
+                    {
+                        output.resize(start);
+                        throw Poco::DataFormatException("Corrupt Snappy chunk.");
+                    }
+                }
+                else
+                {
+                    std::memcpy(uncompressed, payload, payloadSize);
+                }
+
+                if (snappyChecksum(uncompressed, uncompressedSize) != loadLittleEndian32(body))
+                {
+                    output.resize(start);
+                    throw Poco::DataFormatException("Snappy chunk checksum mismatch.");
+                }
+            }
+
+            // Padding and other skippable chunks are ignored.
+            offset += 4 + length;
+        }
+    }
+    else
+    {
+        const std::size_t maxBlockSize = LZ4_compressBound(Compressor::LZ4_LEGACY_BLOCK_SIZE);
+
+        while (size - offset >= 4)
+        {
+            uint32_t value = loadLittleEndian32(data + offset);
+
+            if (!_headerRead && value != LZ4_LEGACY_MAGIC)
+            {
+                throw Poco::DataFormatException("Missing LZ4 legacy frame magic number.");
+            }
+
+            // Legacy frames may be concatenated.
+            if (value == LZ4_LEGACY_MAGIC)
+            {
+                _headerRead = true;
+                offset += 4;
+                continue;
+            }
+
+            std::size_t compressedSize = value;
+
+            if (compressedSize > maxBlockSize)
+            {
+                throw Poco::DataFormatException("Invalid LZ4 block size.");
+            }
+
+            if (size - offset - 4 < compressedSize)
+            {
+                break;
+            }
+
+            std::size_t start = output.size();
+            uint8_t* uncompressed = output.appendUninitialized(Compressor::LZ4_LEGACY_BLOCK_SIZE);
+
+            int result = LZ4_decompress_safe(reinterpret_cast<const char*>(data + offset + 4),
+                                             reinterpret_cast<char*>(uncompressed),
+                                             static_cast<int>(compressedSize),
+                                             Compressor::LZ4_LEGACY_BLOCK_SIZE);
+
+            if (result < 0)
+            {
+                output.resize(start);
+                throw Poco::DataFormatException("Corrupt LZ4 block.");
+            }
+
+            output.resize(start + static_cast<std::size_t>(result));
+            offset += 4 + compressedSize;
+        }
+    }
+
+    return offset;
+}
+
+
+std::size_t Decompressor::_decompressLZ4Frames(const uint8_t* data,
+                                               std::size_t size,
+                                               ByteBuffer& output)
+{
+    LZ4FrameDecoder& frame = *_frame;
+    std::size_t offset = 0;
+
+    for (;;)
+    {
+        const uint8_t* chunk = data + offset;
+        std::size_t available = size - offset;
+
+        if (frame.skipRemaining > 0)
+        {
+            // Skippable frames are passed over without buffering them.
+            std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(frame.skipRemaining, available));
+
+            if (count == 0)
+            {
+                break;
+            }
+
+            frame.skipRemaining -= count;
+            offset += count;
+            continue;
+        }
+
+        if (available < 4)
+        {
+            break;
+        }
+
+        uint32_t value = loadLittleEndian32(chunk);
+
+        if (!_headerRead)
+        {
+            if ((value & 0xFFFFFFF0) == LZ4_SKIPPABLE_MAGIC)
+            {
+                if (available < 8)
+                {
+                    break;
+                }
+
+                frame.skipRemaining = loadLittleEndian32(chunk + 4);
+                offset += 8;
+                continue;
+            }
+
+            if (value != LZ4_FRAME_MAGIC)
+            {
+                throw Poco::DataFormatException("Invalid LZ4 frame magic number.");
+            }
+
+            if (available < 7)
+            {
+                break;
+            }
+
+            uint8_t flags = chunk[4];
+            uint8_t descriptor = chunk[5];
+            int blockSizeId = (descriptor >> 4) & 0x07;
+
+            if ((flags & LZ4_FLAG_VERSION_MASK) != LZ4_FLAG_VERSION ||
+                (flags & LZ4_FLAG_RESERVED) ||
+                (descriptor & 0x8F) ||
+                blockSizeId < LZ4FrameOptions::BLOCK_SIZE_64KB)
+            {
+                throw Poco::DataFormatException("Unsupported LZ4 frame descriptor.");
+            }
+
+            if (flags & LZ4_FLAG_DICTIONARY_ID)
+            {
+                throw Poco::DataFormatException("LZ4 frames with dictionaries are not supported.");
+            }
+
+            std::size_t headerSize = (flags & LZ4_FLAG_CONTENT_SIZE) ? 15 : 7;
+
+            if (available < headerSize)
+            {
+                break;
+            }
+
+            if (static_cast<uint8_t>(XXHash32::hash(chunk + 4, headerSize - 5) >> 8) != chunk[headerSize - 1])
+            {
+                throw Poco::DataFormatException("LZ4 frame header checksum mismatch.");
+            }
+
+            frame.flags = flags;
+            frame.blockMaxSize = std::size_t(1) << (8 + 2 * blockSizeId);
+            frame.contentSize = 0;
+            frame.decompressedSize = 0;
+            frame.contentHash.reset();
+
+            if (flags & LZ4_FLAG_CONTENT_SIZE)
+            {
+                std::memcpy(&frame.contentSize, chunk + 6, sizeof(frame.contentSize));
+                frame.contentSize = ByteOrder::fromLittleEndian(frame.contentSize);
+            }
+
+            if (!(flags & LZ4_FLAG_BLOCK_INDEPENDENCE))
+            {
+                // Linked blocks are decoded after up to 64 KiB of history.
+                frame.window.resizeUninitialized(LZ4_HISTORY_SIZE + frame.blockMaxSize);
+                std::memset(frame.window.getPtr(), 0, LZ4_HISTORY_SIZE);
+            }
+
+            _headerRead = true;
+            offset += headerSize;
+            continue;
+        }
+
+        if (value == 0)
+        {
+            // The end mark, followed by the content checksum.
+            std::size_t trailerSize = (frame.flags & LZ4_FLAG_CONTENT_CHECKSUM) ? 8 : 4;
+
+            if (available < trailerSize)
+            {
+                break;
+            }
+
+            if ((frame.flags & LZ4_FLAG_CONTENT_CHECKSUM) &&
+                frame.contentHash.digest() != loadLittleEndian32(chunk + 4))
+            {
+                throw Poco::DataFormatException("LZ4 frame content checksum mismatch.");
+            }
+
+            if ((frame.flags & LZ4_FLAG_CONTENT_SIZE) &&
+                frame.decompressedSize != frame.contentSize)
+            {
+                throw Poco::DataFormatException("LZ4 frame content size mismatch.");
+            }
+
+            ++frame.framesRead;
+            _headerRead = false;
+            offset += trailerSize;
+            continue;
+        }
+
+        bool isCompressed = !(value & LZ4_UNCOMPRESSED_BLOCK);
+        std::size_t blockSize = value & ~LZ4_UNCOMPRESSED_BLOCK;
+        std::size_t checksumSize = (frame.flags & LZ4_FLAG_BLOCK_CHECKSUM) ? 4 : 0;
+
+        if (blockSize > frame.blockMaxSize)
+        {
+            throw Poco::DataFormatException("Invalid LZ4 block size.");
+        }
+
+        if (available - 4 < blockSize + checksumSize)
+        {
+            break;
+        }
+
+        const uint8_t* block = chunk + 4;
+
+        if (checksumSize > 0 &&
+            XXHash32::hash(block, blockSize) != loadLittleEndian32(block + blockSize))
+        {
+            throw Poco::DataFormatException("LZ4 block checksum mismatch.");
+        }
+
+        // Never decompress past a recorded content size, so that a buffer
+        // reserved for it does not have to grow.
+        std::size_t capacity = frame.blockMaxSize;
+
+        if (frame.flags & LZ4_FLAG_CONTENT_SIZE)
+        {
+            capacity = static_cast<std::size_t>(std::min<uint64_t>(capacity, frame.contentSize - std::min(frame.contentSize, frame.decompressedSize)));
+        }
+
+        const uint8_t* decoded = nullptr;
+        int result = 0;
+
+        if (frame.flags & LZ4_FLAG_BLOCK_INDEPENDENCE)
+        {
+            std::size_t start = output.size();
+            uint8_t* target = output.appendUninitialized(isCompressed ? capacity : blockSize);
+
+            if (isCompressed)
+            {
+                result = LZ4_decompress_safe(reinterpret_cast<const char*>(block),
+                                             reinterpret_cast<char*>(target),
+                                             static_cast<int>(blockSize),
+                                             static_cast<int>(capacity));
+            }
+            else
+            {
+                std::memcpy(target, block, blockSize);
+                result = static_cast<int>(blockSize);
+            }
+
+            output.resize(start + static_cast<std::size_t>(std::max(result, 0)));
+            decoded = output.getPtr() + start;
+        }
+        else
+        {
+            uint8_t* target = frame.window.getPtr() + LZ4_HISTORY_SIZE;
+
+            if (isCompressed)
+            {
+                result = LZ4_decompress_safe_withPrefix64k(reinterpret_cast<const char*>(block),
+                                                           reinterpret_cast<char*>(target),
+                                                           static_cast<int>(blockSize),
+                                                           static_cast<int>(capacity));
+            }
+            else
+            {
+                std::memcpy(target, block, blockSize);
+                result = static_cast<int>(blockSize);
+            }
+
+            if (result >= 0)
+            {
+                output.writeBytes(target, static_cast<std::size_t>(result));
+            }
+
+            decoded = target;
+        }
+
+        if (result < 0)
+        {
+            throw Poco::DataFormatException("Corrupt LZ4 block.");
+        }
+
+        std::size_t count = static_cast<std::size_t>(result);
+
+        if (frame.flags & LZ4_FLAG_CONTENT_CHECKSUM)
+        {
+            frame.contentHash.update(decoded, count);
+        }
+
+        frame.decompressedSize += count;
+
+        if (!(frame.flags & LZ4_FLAG_BLOCK_INDEPENDENCE))
+        {
+            // Keep the last 64 KiB as history for the next block.
+            std::memmove(frame.window.getPtr(), frame.window.getPtr() + count, LZ4_HISTORY_SIZE);
+        }
+
+        offset += 4 + blockSize + checksumSize;
+    }
+
+    return offset;
+}
+
+
+CompressingStreamBuf::CompressingStreamBuf(std::ostream& ostr,
+                                           Compression::Type type):
+    _ostr(&ostr),
+    _compressor(type)
+{
+    char* block = reinterpret_cast<char*>(_block.resizeUninitialized(_compressor.blockSize()));
+    setp(block, block + _block.size());
+}
+
+
+CompressingStreamBuf::~CompressingStreamBuf()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+
+void CompressingStreamBuf::close()
+{
+    if (_ostr)
+    {
+        _compressPutArea();
+        _compressor.finish(_output);
+        _writeOutput();
+        _ostr->flush();
+        _ostr = nullptr;
+        setp(nullptr, nullptr);
+    }
+}
+
+
+CompressingStreamBuf::int_type CompressingStreamBuf::overflow(int_type c)
+{
+    if (!_ostr)
+    {
+        return traits_type::eof();
+    }
+
+    _compressPutArea();
+
+    if (!_ostr->good())
+    {
+        return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+
+std::streamsize CompressingStreamBuf::xsputn(const char_type* buffer,
+                                             std::streamsize size)
+{
+    if (!_ostr)
+    {
+        return 0;
+    }
+
+    std::size_t blockSize = _compressor.blockSize();
+    std::size_t count = static_cast<std::size_t>(size);
+
+    // Compress whole blocks straight from the caller's buffer.
+    if (pptr() == pbase() && count >= blockSize)
+    {
+        std::size_t direct = count - count % blockSize;
+        _compressor.update(ByteBufferView(buffer, direct), _output);
+        _writeOutput();
+
+        if (!_ostr->good())
+        {
+            return 0;
+        }
+
+        return static_cast<std::streamsize>(direct) +
+               std::streambuf::xsputn(buffer + direct, static_cast<std::streamsize>(count - direct));
+    }
+
+    return std::streambuf::xsputn(buffer, size);
+}
+
+
+int CompressingStreamBuf::sync()
+{
+    if (!_ostr)
+    {
+        return 0;
+    }
+
+    _compressPutArea();
+    _compressor.flush(_output);
+    _writeOutput();
+    _ostr->flush();
+
+    return _ostr->good() ? 0 : -1;
+}
+
+
+void CompressingStreamBuf::_compressPutArea()
+{
+    std::size_t count = static_cast<std::size_t>(pptr() - pbase());
+
+    if (count > 0)
+    {
+        _compressor.update(ByteBufferView(pbase(), count), _output);
+        setp(pbase(), epptr());
+    }
+
+    _writeOutput();
+}
+
+
+void CompressingStreamBuf::_writeOutput()
+{
+    if (!_output.empty())
+    {
+        _ostr->write(_output.getCharPtr(), static_cast<std::streamsize>(_output.size()));
+        _output.clear();
+    }
+}
+
+
+DecompressingStreamBuf::DecompressingStreamBuf(std::istream& istr,
+                                               Compression::Type type):
+    _istr(&istr),
+    _decompressor(type),
+    _eof(false)
+{
+    _input.resizeUninitialized(DEFAULT_BUFFER_SIZE);
+    setg(nullptr, nullptr, nullptr);
+}
+
+
+DecompressingStreamBuf::~DecompressingStreamBuf()
+{
+}
+
+
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    _output.clear();
+
+    while (_output.empty())
+    {
+        if (_eof)
+        {
+            setg(nullptr, nullptr, nullptr);
+            return traits_type::eof();
+        }
+
+        _istr->read(_input.getCharPtr(), static_cast<std::streamsize>(_input.size()));
+        std::streamsize count = _istr->gcount();
+
+        if (count > 0)
+        {
+            _decompressor.update(ByteBufferView(_input.getPtr(), static_cast<std::size_t>(count)),
+                                 _output);
+        }
+        else
+        {
+            _eof = true;
+            _decompressor.finish();
+        }
+    }
+
+    char* data = _output.getCharPtr();
+    setg(data, data, data + _output.size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,247 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/FileChunkReader.h"
+#include <cerrno>
+#include <cstring>
+#include "Poco/Exception.h"
+#include "Poco/FileStream.h"
+
+
+#if defined(POCO_OS_FAMILY_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+FileChunkReader::FileChunkReader(const std::string& path,
+                                 std::size_t chunkSize):
+    _path(path),
+    _chunkSize(chunkSize > 0 ? chunkSize : static_cast<std::size_t>(DEFAULT_CHUNK_SIZE)),
+    _chunkOffset(0),
+    _bytesRead(0),
+    _fd(-1),
+    _ready(false),
+    _done(false),
+    _stopping(false)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    do
+    {
+        _fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    while (_fd < 0 && errno == EINTR);
+
+    if (_fd < 0)
+    {
+        switch (errno)
+        {
+            case ENOENT:
+                throw Poco::FileNotFoundException(_path);
+            case EACCES:
+                throw Poco::FileAccessDeniedException(_path);
+            default:
+                throw Poco::OpenFileException(_path, std::strerror(errno));
+        }
+    }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#else
+    _stream.reset(new Poco::FileInputStream(_path, std::ios::in | std::ios::binary));
+#endif
+
+    _thread = std::thread(&FileChunkReader::_run, this);
+}
+
+
+FileChunkReader::~FileChunkReader()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _condition.notify_all();
+    _thread.join();
+
+#if defined(POCO_OS_FAMILY_UNIX)
+    ::close(_fd);
+#endif
+}
+
+
+bool FileChunkReader::next(ByteBuffer& chunk)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [this] { return _ready || _done; });
+
+    if (_ready)
+    {
+        // Hand the caller's old buffer back to be refilled.
+        chunk.swap(_pending);
+        _ready = false;
+        _chunkOffset = _bytesRead;
+        _bytesRead += chunk.size();
+        lock.unlock();
+        _condition.notify_all();
+        return true;
+    }
+
+    chunk.clear();
+
+    if (_exception)
+    {
+        std::exception_ptr exception = _exception;
+        _exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+
+    return false;
+}
+
+
+std::size_t FileChunkReader::getChunkOffset() const
+{
+    return _chunkOffset;
+}
+
+
+std::size_t FileChunkReader::getBytesRead() const
+{
+    return _bytesRead;
+}
+
+
+std::size_t FileChunkReader::getChunkSize() const
+{
+    return _chunkSize;
+}
+
+
+const std::string& FileChunkReader::getPath() const
+{
+    return _path;
+}
+
+
+std::size_t FileChunkReader::_readChunk(ByteBuffer& buffer)
+{
+    uint8_t* data = buffer.resizeUninitialized(_chunkSize);
+    std::size_t total = 0;
+
+#if defined(POCO_OS_FAMILY_UNIX)
+    // Pipes and devices may return less than requested before the end.
+    while (total < _chunkSize)
+    {
+        ssize_t result = ::read(_fd, data + total, _chunkSize - total);
+
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            throw Poco::ReadFileException(_path, std::strerror(errno));
+        }
+        else if (result == 0)
+        {
+            break;
+        }
+
+        total += static_cast<std::size_t>(result);
+    }
+#else
+    _stream->read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(_chunkSize));
+    total = static_cast<std::size_t>(_stream->gcount());
+
+    if (_stream->bad())
+    {
+        throw Poco::ReadFileException(_path);
+    }
+#endif
+
+    buffer.resize(total);
+
+    return total;
+}
+
+
+void FileChunkReader::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (;;)
+    {
+        _condition.wait(lock, [this] { return _stopping || !_ready; });
+
+        if (_stopping)
+        {
+            return;
+        }
+
+        // Read into the spare buffer without holding the lock.
+        ByteBuffer buffer;
+        buffer.swap(_pending);
+        lock.unlock();
+
+        std::size_t count = 0;
+        std::exception_ptr exception;
+
+        try
+        {
+            count = _readChunk(buffer);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+        _pending.swap(buffer);
+
+        if (count > 0)
+        {
+            _ready = true;
+        }
+        else
+        {
+            _exception = exception;
+            _done = true;
+        }
+
+        _condition.notify_all();
+
+        if (_done)
+        {
+            return;
+        }
+    }
+}
+
+
+} }  // namespace ofx::IO
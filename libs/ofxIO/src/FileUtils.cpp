@@ -0,0 +1,418 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/FileUtils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include "Poco/Exception.h"
+#include "Poco/File.h"
+#include "Poco/Path.h"
+#include "ofUtils.h"
+
+
+#if defined(POCO_OS_FAMILY_UNIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+#include <copyfile.h>
+#include <sys/clonefile.h>
+#endif
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+std::size_t FileUtils::copy(const std::string& sourcePath,
+                            const std::string& targetPath,
+                            int options)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    int sourceFd = -1;
+
+    do
+    {
+        sourceFd = ::open(sourcePath.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    while (sourceFd < 0 && errno == EINTR);
+
+    if (sourceFd < 0)
+    {
+        switch (errno)
+        {
+            case ENOENT:
+                throw Poco::FileNotFoundException(sourcePath);
+            case EACCES:
+                throw Poco::FileAccessDeniedException(sourcePath);
+            default:
+                throw Poco::OpenFileException(sourcePath, std::strerror(errno));
+        }
+    }
+
+    struct stat sourceStatus;
+    struct stat targetStatus;
+
+    if (::fstat(sourceFd, &sourceStatus) != 0)
+    {
+        int error = errno;
+        ::close(sourceFd);
+        throw Poco::ReadFileException(sourcePath, std::strerror(error));
+    }
+
+    if (S_ISDIR(sourceStatus.st_mode))
+    {
+        ::close(sourceFd);
+        throw Poco::OpenFileException(sourcePath, "Is a directory.");
+    }
+
+    bool targetExists = ::stat(targetPath.c_str(), &targetStatus) == 0;
+
+    // Opening the target with O_TRUNC would destroy the source.
+    if (targetExists &&
+        targetStatus.st_dev == sourceStatus.st_dev &&
+        targetStatus.st_ino == sourceStatus.st_ino)
+    {
+        ::close(sourceFd);
+        throw Poco::InvalidArgumentException("The source and target are the same file.", targetPath);
+    }
+
+    // Special files may report a size of 0, so only trust regular files.
+    std::size_t size = S_ISREG(sourceStatus.st_mode) ? static_cast<std::size_t>(sourceStatus.st_size) : 0;
+
+#if defined(__APPLE__)
+    if (!(options & COPY_NO_REFLINK) && !targetExists && size > 0 &&
+        ::clonefile(sourcePath.c_str(), targetPath.c_str(), 0) == 0)
+    {
+        ::close(sourceFd);
+        return size;
+    }
+#endif
+
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    flags |= (options & COPY_OVERWRITE) ? O_TRUNC : O_EXCL;
+
+    int targetFd = -1;
+
+    do
+    {
+        targetFd = ::open(targetPath.c_str(), flags, sourceStatus.st_mode & 0777);
+    }
+    while (targetFd < 0 && errno == EINTR);
+
+    if (targetFd < 0)
+    {
+        int error = errno;
+        ::close(sourceFd);
+
+        if (error == EEXIST)
+        {
+            throw Poco::FileExistsException(targetPath);
+        }
+
+        throw Poco::CreateFileException(targetPath, std::strerror(error));
+    }
+
+    std::size_t total = 0;
+
+    try
+    {
+        total = _copyFileDescriptor(sourceFd, targetFd, size, options);
+
+        int result = ::close(targetFd);
+        targetFd = -1;
+
+        if (result != 0)
+        {
+            throw Poco::WriteFileException(targetPath, std::strerror(errno));
+        }
+    }
+    catch (...)
+    {
+        if (targetFd >= 0)
+        {
+            ::close(targetFd);
+        }
+
+        ::close(sourceFd);
+        ::unlink(targetPath.c_str());
+        throw;
+    }
+
+    ::close(sourceFd);
+
+    return total;
+#else
+    Poco::File source(sourcePath);
+    Poco::File target(targetPath);
+
+    if (!(options & COPY_OVERWRITE) && target.exists())
+    {
+        throw Poco::FileExistsException(targetPath);
+    }
+
+    source.copyTo(targetPath);
+
+    return static_cast<std::size_t>(source.getSize());
+#endif
+}
+
+
+std::size_t FileUtils::copy(const std::vector<std::string>& paths,
+                            const std::string& sourceDirectory,
+                            const std::string& targetDirectory,
+                            int options)
+{
+    const char separator = Poco::Path::separator();
+
+    std::string sourceRoot = sourceDirectory;
+    std::string targetRoot = targetDirectory;
+
+    if (!sourceRoot.empty() && sourceRoot[sourceRoot.size() - 1] != separator)
+    {
+        sourceRoot += separator;
+    }
+
+    if (!targetRoot.empty() && targetRoot[targetRoot.size() - 1] != separator)
+    {
+        targetRoot += separator;
+    }
+
+    std::size_t total = 0;
+
+    // Consecutive files usually share a parent, so only create it once.
+    std::string lastParent;
+
+    for (const auto& path: paths)
+    {
+        if (path.compare(0, sourceRoot.size(), sourceRoot) != 0)
+        {
+            throw Poco::InvalidArgumentException("The path is not inside " + sourceDirectory, path);
+        }
+
+        std::string target = targetRoot + path.substr(sourceRoot.size());
+
+        if (Poco::File(path).isDirectory())
+        {
+            Poco::File(target).createDirectories();
+        }
+        else
+        {
+            std::string parent = Poco::Path(target).parent().toString();
+
+            if (parent != lastParent)
+            {
+                Poco::File(parent).createDirectories();
+                lastParent = parent;
+            }
+
+            total += copy(path, target, options);
+        }
+    }
+
+    return total;
+}
+
+
+std::size_t FileUtils::copyRecursive(const std::string& sourceDirectory,
+                                     const std::string& targetDirectory,
+                                     int options,
+                                     AbstractPathFilter* pFilter,
+                                     Poco::UInt16 maxDepth)
+{
+    std::string source = ofToDataPath(sourceDirectory, true);
+    std::string target = ofToDataPath(targetDirectory, true);
+
+    std::vector<std::string> paths;
+
+    // Siblings first keeps the files of each directory together.
+    DirectoryUtils::listRecursive(source,
+                                  paths,
+                                  false,
+                                  pFilter,
+                                  maxDepth,
+                                  DirectoryUtils::SIBLINGS_FIRST);
+
+    Poco::File(target).createDirectories();
+
+    return copy(paths, source, target, options);
+}
+
+
+std::size_t FileUtils::_copyFileDescriptor(int sourceFd,
+                                           int targetFd,
+                                           std::size_t size,
+                                           int options)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    std::size_t total = 0;
+
+#if defined(__linux__)
+    if (size > 0)
+    {
+#if defined(FICLONE)
+        if (!(options & COPY_NO_REFLINK) && ::ioctl(targetFd, FICLONE, sourceFd) == 0)
+        {
+            return size;
+        }
+#endif
+
+        // The kernel copies are abandoned for read() / write() if the first
+        // call is not supported, e.g. across file systems on older kernels.
+        bool useKernel = true;
+
+#if defined(SYS_copy_file_range)
+        while (useKernel)
+        {
+            ssize_t result = ::syscall(SYS_copy_file_range,
+                                       sourceFd,
+                                       nullptr,
+                                       targetFd,
+                                       nullptr,
+                                       std::size_t(0x40000000),
+                                       0u);
+
+            if (result > 0)
+            {
+                total += static_cast<std::size_t>(result);
+            }
+            else if (result == 0)
+            {
+                // Some pseudo file systems report 0 rather than an error.
+                if (total > 0) return total;
+                break;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            else if (total == 0 &&
+                     (errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+                      errno == EOPNOTSUPP || errno == EPERM))
+            {
+                break;
+            }
+            else
+            {
+                throw Poco::WriteFileException(std::strerror(errno));
+            }
+        }
+#endif
+
+        while (useKernel)
+        {
+            ssize_t result = ::sendfile(targetFd, sourceFd, nullptr, 0x7ffff000);
+
+            if (result > 0)
+            {
+                total += static_cast<std::size_t>(result);
+            }
+            else if (result == 0)
+            {
+                if (total > 0) return total;
+                break;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            else if (total == 0 && (errno == ENOSYS || errno == EINVAL))
+            {
+                useKernel = false;
+            }
+            else
+            {
+                throw Poco::WriteFileException(std::strerror(errno));
+            }
+        }
+    }
+#elif defined(__APPLE__)
+    if (size > 0 && ::fcopyfile(sourceFd, targetFd, nullptr, COPYFILE_DATA) == 0)
+    {
+        return size;
+    }
+
+    (void)options;
+#else
+    (void)size;
+    (void)options;
+#endif
+
+    std::vector<uint8_t> buffer(COPY_BUFFER_SIZE);
+
+    for (;;)
+    {
+        ssize_t count = ::read(sourceFd, buffer.data(), buffer.size());
+
+        if (count < 0)
+        {
+            if (errno == EINTR) continue;
+            throw Poco::ReadFileException(std::strerror(errno));
+        }
+        else if (count == 0)
+        {
+            break;
+        }
+
+        std::size_t written = 0;
+
+        while (written < static_cast<std::size_t>(count))
+        {
+            ssize_t result = ::write(targetFd,
+                                     buffer.data() + written,
+                                     static_cast<std::size_t>(count) - written);
+
+            if (result < 0)
+            {
+                if (errno == EINTR) continue;
+                throw Poco::WriteFileException(std::strerror(errno));
+            }
+
+            written += static_cast<std::size_t>(result);
+        }
+
+        total += written;
+    }
+
+    return total;
+#else
+    (void)sourceFd;
+    (void)targetFd;
+    (void)size;
+    (void)options;
+    throw Poco::NotImplementedException("FileUtils::_copyFileDescriptor");
+#endif
+}
+
+
+} } // namespace ofx::IO
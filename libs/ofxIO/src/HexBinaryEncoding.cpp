@@ -28,6 +28,8 @@
 #include "Poco/HexBinaryEncoder.h"
 #include "Poco/HexBinaryDecoder.h"
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferStream.h"
+#include "ofx/IO/ByteBufferView.h"
 
 
 namespace ofx {
@@ -47,25 +49,35 @@ HexBinaryEncoding::~HexBinaryEncoding()
 std::size_t HexBinaryEncoding::encode(const ByteBuffer& buffer,
                                       ByteBuffer& encodedBuffer)
 {
-    std::stringstream ss;
-    Poco::HexBinaryEncoder _encoder(ss);
-    ByteBuffer byteBuffer(buffer.readBytes());
-    ByteBufferUtils::copyBufferToStream(byteBuffer, _encoder);
+    return encode(ByteBufferView(buffer), encodedBuffer);
+}
+
+
+std::size_t HexBinaryEncoding::decode(const ByteBuffer& buffer,
+                                      ByteBuffer& decodedBuffer)
+{
+    return decode(ByteBufferView(buffer), decodedBuffer);
+}
+
+
+std::size_t HexBinaryEncoding::encode(const ByteBufferView& buffer,
+                                      ByteBuffer& encodedBuffer)
+{
+    ByteBufferOutputStream ostr(encodedBuffer);
+    Poco::HexBinaryEncoder _encoder(ostr);
+    ByteBufferUtils::copyBufferToStream(buffer, _encoder);
     _encoder.close(); // Flush bytes.
-    encodedBuffer.writeBytes(ss.str());
+    ostr.flush();
     return encodedBuffer.size();
 }
 
-std::size_t HexBinaryEncoding::decode(const ByteBuffer& buffer,
+
+std::size_t HexBinaryEncoding::decode(const ByteBufferView& buffer,
                                       ByteBuffer& decodedBuffer)
 {
-    ByteBuffer byteBuffer(buffer.readBytes());
-    std::stringstream ss;
-    ss << byteBuffer;
-    Poco::HexBinaryDecoder _decoder(ss);
-    ByteBuffer decoded;
-    ByteBufferUtils::copyStreamToBuffer(_decoder, decoded);
-    decodedBuffer.writeBytes(decoded);
+    ByteBufferInputStream istr(buffer);
+    Poco::HexBinaryDecoder _decoder(istr);
+    ByteBufferUtils::copyStreamToBuffer(_decoder, decodedBuffer);
     return decodedBuffer.size();
 }
 
@@ -0,0 +1,295 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/MappedByteBuffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "Poco/Exception.h"
+
+
+#if defined(POCO_OS_FAMILY_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+MappedByteBuffer::MappedByteBuffer(): _data(nullptr), _size(0)
+{
+}
+
+
+MappedByteBuffer::MappedByteBuffer(const std::string& path,
+                                   AccessPattern pattern):
+    _data(nullptr),
+    _size(0)
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    int fd = -1;
+
+    do
+    {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    while (fd < 0 && errno == EINTR);
+
+    if (fd < 0)
+    {
+        int error = errno;
+
+        if (error == ENOENT)
+        {
+            throw Poco::FileNotFoundException(path);
+        }
+        else if (error == EACCES)
+        {
+            throw Poco::FileAccessDeniedException(path);
+        }
+
+        throw Poco::OpenFileException(path, std::strerror(error));
+    }
+
+    struct stat status;
+
+    if (::fstat(fd, &status) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw Poco::FileException(path, std::strerror(error));
+    }
+
+    if (!S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        throw Poco::FileException(path, "Not a regular file.");
+    }
+
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+
+    // An empty file cannot be mapped and is represented by an empty buffer.
+    if (size > 0)
+    {
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw Poco::FileException(path, std::strerror(error));
+        }
+
+        _data = static_cast<uint8_t*>(data);
+        _size = size;
+    }
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if (pattern != ACCESS_NORMAL)
+    {
+        advise(pattern);
+    }
+#else
+    (void)path;
+    (void)pattern;
+    throw Poco::NotImplementedException("MappedByteBuffer");
+#endif
+}
+
+
+MappedByteBuffer::MappedByteBuffer(MappedByteBuffer&& that) noexcept:
+    _data(that._data),
+    _size(that._size)
+{
+    that._data = nullptr;
+    that._size = 0;
+}
+
+
+MappedByteBuffer& MappedByteBuffer::operator = (MappedByteBuffer&& that) noexcept
+{
+    if (this != &that)
+    {
+        close();
+        _data = that._data;
+        _size = that._size;
+        that._data = nullptr;
+        that._size = 0;
+    }
+
+    return *this;
+}
+
+
+MappedByteBuffer::~MappedByteBuffer()
+{
+    close();
+}
+
+
+std::size_t MappedByteBuffer::readBytes(uint8_t* buffer, std::size_t size) const
+{
+    return view().readBytes(buffer, size);
+}
+
+
+std::size_t MappedByteBuffer::readBytes(std::vector<uint8_t>& buffer) const
+{
+    return view().readBytes(buffer);
+}
+
+
+std::size_t MappedByteBuffer::readBytes(std::string& buffer) const
+{
+    return view().readBytes(buffer);
+}
+
+
+std::size_t MappedByteBuffer::readBytes(AbstractByteSink& buffer) const
+{
+    return view().readBytes(buffer);
+}
+
+
+std::vector<uint8_t> MappedByteBuffer::readBytes() const
+{
+    return view().readBytes();
+}
+
+
+const uint8_t* MappedByteBuffer::getContiguousPtr() const
+{
+    return _data;
+}
+
+
+std::size_t MappedByteBuffer::size() const
+{
+    return _size;
+}
+
+
+bool MappedByteBuffer::empty() const
+{
+    return _size == 0;
+}
+
+
+void MappedByteBuffer::close()
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    if (_data != nullptr)
+    {
+        ::munmap(_data, _size);
+    }
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+
+void MappedByteBuffer::advise(AccessPattern pattern,
+                              std::size_t offset,
+                              std::size_t size) const
+{
+#if defined(POCO_OS_FAMILY_UNIX)
+    if (_data == nullptr || offset >= _size)
+    {
+        return;
+    }
+
+    size = std::min(size, _size - offset);
+
+    // The advised range must start on a page boundary.
+    std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t alignedOffset = offset - (offset % pageSize);
+    size += offset - alignedOffset;
+
+    int advice = POSIX_MADV_NORMAL;
+
+    switch (pattern)
+    {
+        case ACCESS_NORMAL:
+            advice = POSIX_MADV_NORMAL;
+            break;
+        case ACCESS_SEQUENTIAL:
+            advice = POSIX_MADV_SEQUENTIAL;
+            break;
+        case ACCESS_RANDOM:
+            advice = POSIX_MADV_RANDOM;
+            break;
+        case ACCESS_WILL_NEED:
+            advice = POSIX_MADV_WILLNEED;
+            break;
+    }
+
+    ::posix_madvise(_data + alignedOffset, size, advice);
+#else
+    (void)pattern;
+    (void)offset;
+    (void)size;
+#endif
+}
+
+
+uint8_t MappedByteBuffer::operator [] (std::size_t n) const
+{
+    return _data[n];
+}
+
+
+const uint8_t* MappedByteBuffer::getPtr() const
+{
+    return _data;
+}
+
+
+const char* MappedByteBuffer::getCharPtr() const
+{
+    return reinterpret_cast<const char*>(_data);
+}
+
+
+ByteBufferView MappedByteBuffer::view(std::size_t offset,
+                                      std::size_t size) const
+{
+    return ByteBufferView(_data, _size).subview(offset, size);
+}
+
+
+MappedByteBuffer::operator ByteBufferView() const
+{
+    return view();
+}
+
+
+} }  // namespace ofx::IO
@@ -43,14 +43,27 @@ SLIPEncoding::~SLIPEncoding()
 
 std::size_t SLIPEncoding::encode(const ByteBuffer& buffer,
                                  ByteBuffer& encodedBuffer)
+{
+    return encode(ByteBufferView(buffer), encodedBuffer);
+}
+
+
+std::size_t SLIPEncoding::decode(const ByteBuffer& buffer,
+                                 ByteBuffer& decodedBuffer)
+{
+    return decode(ByteBufferView(buffer), decodedBuffer);
+}
+
+
+std::size_t SLIPEncoding::encode(const ByteBufferView& buffer,
+                                 ByteBuffer& encodedBuffer)
 {
     if (buffer.size() > 0)
     {
         const std::size_t encodedMax = 2 * buffer.size() + 2;
-        encodedBuffer.resize(encodedMax);
         std::size_t size = encode(buffer.getPtr(),
                                   buffer.size(),
-                                  encodedBuffer.getPtr());
+                                  encodedBuffer.resizeUninitialized(encodedMax));
         encodedBuffer.resize(size);
         return encodedBuffer.size();
     }
@@ -61,15 +74,14 @@ std::size_t SLIPEncoding::encode(const ByteBuffer& buffer,
 }
 
 
-std::size_t SLIPEncoding::decode(const ByteBuffer& buffer,
+std::size_t SLIPEncoding::decode(const ByteBufferView& buffer,
                                  ByteBuffer& decodedBuffer)
 {
     if (buffer.size() > 0)
     {
-        decodedBuffer.resize(buffer.size());
         std::size_t size = decode(buffer.getPtr(),
                                   buffer.size(),
-                                  decodedBuffer.getPtr());
+                                  decodedBuffer.resizeUninitialized(buffer.size()));
         decodedBuffer.resize(size);
         return decodedBuffer.size();
     }
@@ -80,6 +92,25 @@ std::size_t SLIPEncoding::decode(const ByteBuffer& buffer,
 }
 
 
+std::size_t SLIPEncoding::decode(ByteBuffer&& buffer,
+                                 ByteBuffer& decodedBuffer)
+{
+    if (buffer.size() > 0)
+    {
+        std::size_t size = decode(buffer.getPtr(),
+                                  buffer.size(),
+                                  buffer.getPtr());
+        buffer.resize(size);
+        decodedBuffer = std::move(buffer);
+        return decodedBuffer.size();
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+
 std::size_t SLIPEncoding::encode(const uint8_t* buffer,
                                  std::size_t size,
                                  uint8_t* encoded)
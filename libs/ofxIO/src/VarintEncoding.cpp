@@ -0,0 +1,134 @@
+// =============================================================================
+//
+// Copyright (c) 2016 Christopher Baker <http://christopherbaker.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// =============================================================================
+
+
+#include "ofx/IO/VarintEncoding.h"
+#include <algorithm>
+#include <cstring>
+#include "ofx/IO/ByteOrder.h"
+
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+std::size_t VarintEncoding::encode(uint64_t value, uint8_t* encodedBuffer)
+{
+    if (value < 0x80)
+    {
+        encodedBuffer[0] = static_cast<uint8_t>(value);
+        return 1;
+    }
+
+    std::size_t size = encodedSize(value);
+    std::size_t last = size - 1;
+
+    for (std::size_t i = 0; i < last; ++i)
+    {
+        encodedBuffer[i] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+
+    encodedBuffer[last] = static_cast<uint8_t>(value);
+    return size;
+}
+
+
+std::size_t VarintEncoding::decode(const uint8_t* buffer,
+                                   std::size_t size,
+                                   uint64_t& value)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    if (buffer[0] < 0x80)
+    {
+        value = buffer[0];
+        return 1;
+    }
+
+#if defined(__GNUC__)
+    if (size >= 8)
+    {
+        // Load eight bytes and find the first byte with a clear high bit.
+        uint64_t word;
+        std::memcpy(&word, buffer, sizeof(word));
+        word = ByteOrder::toLittleEndian(word);
+
+        uint64_t stops = ~word & 0x8080808080808080ULL;
+
+        if (stops != 0)
+        {
+            std::size_t n = static_cast<std::size_t>(__builtin_ctzll(stops)) / 8 + 1;
+            uint64_t bytes = (n == 8) ? word : (word & ((1ULL << (n * 8)) - 1));
+
+#if defined(__BMI2__)
+            value = _pext_u64(bytes, 0x7F7F7F7F7F7F7F7FULL);
+#else
+            // Pack the seven bit groups together in three steps.
+            uint64_t x = bytes & 0x7F7F7F7F7F7F7F7FULL;
+            x = ((x & 0x7F007F007F007F00ULL) >> 1) | (x & 0x007F007F007F007FULL);
+            x = ((x & 0x3FFF00003FFF0000ULL) >> 2) | (x & 0x00003FFF00003FFFULL);
+            x = ((x & 0x0FFFFFFF00000000ULL) >> 4) | (x & 0x000000000FFFFFFFULL);
+            value = x;
+#endif
+            return n;
+        }
+    }
+#endif
+
+    uint64_t result = 0;
+    std::size_t limit = std::min<std::size_t>(size, MAX_ENCODED_SIZE);
+
+    for (std::size_t i = 0; i < limit; ++i)
+    {
+        uint64_t byte = buffer[i];
+
+        // The tenth byte may only carry the single remaining bit.
+        if (i == MAX_ENCODED_SIZE - 1 && byte > 1)
+        {
+            return 0;
+        }
+
+        result |= (byte & 0x7F) << (7 * i);
+
+        if (byte < 0x80)
+        {
+            value = result;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+
+} } // namespace ofx::IO
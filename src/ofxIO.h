@@ -40,23 +40,37 @@
 #include "ofx/UniqueAccessExpireCache.h"
 #include "ofx/UniqueAccessExpireLRUCache.h"
 #include "ofx/IO/AbstractTypes.h"
+#include "ofx/IO/AsyncFileIO.h"
 #include "ofx/IO/Base64Encoding.h"
+#include "ofx/IO/BitReader.h"
+#include "ofx/IO/BitWriter.h"
 #include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/ByteBufferPool.h"
 #include "ofx/IO/ByteBufferReader.h"
 #include "ofx/IO/ByteBufferStream.h"
 #include "ofx/IO/ByteBufferUtils.h"
+#include "ofx/IO/ByteBufferView.h"
 #include "ofx/IO/ByteBufferWriter.h"
+#include "ofx/IO/ByteOrder.h"
+#include "ofx/IO/ByteRingBuffer.h"
+#include "ofx/IO/ChainedByteBuffer.h"
 #include "ofx/IO/COBSEncoding.h"
 #include "ofx/IO/SLIPEncoding.h"
+#include "ofx/IO/StructSchema.h"
+#include "ofx/IO/VarintEncoding.h"
 #include "ofx/IO/Compression.h"
+#include "ofx/IO/CompressionStream.h"
 #include "ofx/IO/DeviceFilter.h"
 #include "ofx/IO/DirectoryUtils.h"
 #include "ofx/IO/DirectoryFilter.h"
 #include "ofx/IO/DirectoryWatcherManager.h"
+#include "ofx/IO/FileChunkReader.h"
 #include "ofx/IO/FileExtensionFilter.h"
+#include "ofx/IO/FileUtils.h"
 #include "ofx/IO/HexBinaryEncoding.h"
 #include "ofx/IO/HiddenFileFilter.h"
 #include "ofx/IO/LinkFilter.h"
+#include "ofx/IO/MappedByteBuffer.h"
 #include "ofx/IO/PathFilterCollection.h"
 #include "ofx/IO/RegexPathFilter.h"
 #include "ofx/IO/SearchPath.h"